@@ -1,42 +1,100 @@
-/* 
- * File:   ADC.c
- * Author: giada
- *
- * Created on December 17, 2024, 8:50 AM
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-
-#include <p32xxxx.h>
-
-void init_ADC(){
-    ANSELBbits.ANSB2 = 1;// = 0xFFFB ; // PORTB = Digital; RB2 = analog
-    /* uncomment for Manual sampling */
-    //AD1CON1 = 0x0000;   // SAMP bit = 0 ends sampling
-                        // and starts converting
-    /* uncomment for Automatic sampling */
-    AD1CON1 = 0x0004;   // ASAM bit = 1 implies acquisition
-                        // starts immediately after last
-                        // conversion is done
-    AD1CHS = 0x00020000; // Connect RB2/AN2 as CH0 input
-                         // in this example RB2/AN2 is the input
-    AD1CSSL = 0;
-    AD1CON3 = 0x0002; // TAD = internal 6 TPB
-    AD1CON2 = 0;
-    AD1CON1SET = 0x8000 ; // turn on the ADC
-}
-
-int adc_measure()
-{
-    /* uncomment for Automatic sampling */
-    Delayms(100); // for 100 ms
-    AD1CON1CLR = 0x0002; // start Converting
-    
-    /* uncomment for Manual sampling */
-//    AD1CON1SET = 0x0002 ; // start sampling...
-//    Delayms(100); // for 100 ms
-//    AD1CON1CLR = 0x0002; // start Converting
-    while(!(AD1CON1 & 0x0001)); // conversion done ?
-    return ADC1BUF0;
-}
\ No newline at end of file
+/* 
+ * File:   ADC.c
+ * Author: giada
+ *
+ * Created on December 17, 2024, 8:50 AM
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <p32xxxx.h>
+#include "ADC.h"
+#include "clock.h"
+#include "Timer.h"
+#include "mem.h"
+
+void init_ADC(){
+    ANSELBbits.ANSB2 = 1;// = 0xFFFB ; // PORTB = Digital; RB2 = analog
+    /* uncomment for Manual sampling */
+    //AD1CON1 = 0x0000;   // SAMP bit = 0 ends sampling
+                        // and starts converting
+    /* uncomment for Automatic sampling */
+    AD1CON1 = 0x0004;   // ASAM bit = 1 implies acquisition
+                        // starts immediately after last
+                        // conversion is done
+    AD1CHS = 0x00020000; // Connect RB2/AN2 as CH0 input
+                         // in this example RB2/AN2 is the input
+    AD1CSSL = 0;
+    AD1CON3 = 0x0002; // TAD = internal 6 TPB
+    AD1CON2 = 0;
+    AD1CON1SET = 0x8000 ; // turn on the ADC
+}
+
+int adc_measure()
+{
+    /* uncomment for Automatic sampling */
+    Delayms(100); // for 100 ms
+    AD1CON1CLR = 0x0002; // start Converting
+    
+    /* uncomment for Manual sampling */
+//    AD1CON1SET = 0x0002 ; // start sampling...
+//    Delayms(100); // for 100 ms
+//    AD1CON1CLR = 0x0002; // start Converting
+    while(!(AD1CON1 & 0x0001)); // conversion done ?
+    return ADC1BUF0;
+}
+
+// Acquisizione veloce: a ogni tick del Timer5 si legge la conversione
+// avviata al tick precedente e se ne avvia un'altra (il campionamento
+// riparte da solo, ASAM = 1)
+static volatile int16_t *fast_buf;
+static volatile int fast_count = 0;
+static volatile int fast_length = 0;
+
+void adc_fast_start(volatile int16_t *buf, int n, unsigned int hz)
+{
+    T5CONbits.ON = 0;
+    IEC0bits.T5IE = 0;
+    fast_buf = buf;
+    fast_length = n;
+    fast_count = -1; // il primo tick avvia solo la conversione
+
+    T5CONbits.TCKPS = 0; // prescaler 1:1, PR5 = PBCLK / hz - 1 (16 bit se hz > PBCLK / 65536)
+    T5CONbits.TCS = 0;
+    TMR5 = 0;
+    PR5 = clock_pbclk() / hz - 1;
+    // Sopra i produttori di eventi: il jitter sposterebbe le frequenze.
+    // L'ISR non usa la coda eventi
+    IPC5bits.T5IP = 2;
+    IPC5bits.T5IS = 0;
+    IFS0bits.T5IF = 0;
+    IEC0bits.T5IE = 1;
+    T5CONbits.ON = 1;
+}
+
+int adc_fast_done(void)
+{
+    return fast_count >= fast_length;
+}
+
+void adc_fast_stop(void)
+{
+    T5CONbits.ON = 0;
+    IEC0bits.T5IE = 0;
+    fast_length = 0;
+}
+
+void __attribute__((interrupt(ipl2AUTO), vector(_TIMER_5_VECTOR))) Timer5Interrupt(void)
+{
+    MEM_ISR_PROBE();
+    if (fast_count >= 0)
+        fast_buf[fast_count] = ADC1BUF0;
+    if (++fast_count < fast_length) {
+        AD1CON1CLR = 0x0002; // SAMP = 0: avvia la conversione
+    } else {
+        T5CONbits.ON = 0;
+        IEC0bits.T5IE = 0;
+    }
+    IFS0bits.T5IF = 0;
+}
@@ -1,10 +1,18 @@
-/* 
- * File:   ADC.h
- * Author: giada
- *
- * Created on December 17, 2024, 8:51 AM
- */
-
-void init_ADC(void);
-int adc_measure(void);
-
+/* 
+ * File:   ADC.h
+ * Author: giada
+ *
+ * Created on December 17, 2024, 8:51 AM
+ */
+
+void init_ADC(void);
+int adc_measure(void);
+
+#include <stdint.h>
+
+// Acquisizione a interrupt di n campioni di AN2 a hz campioni al secondo,
+// cadenzata dal Timer5. Ritorna subito; adc_fast_done() vale 1 quando buf
+// è pieno. adc_measure() non va usata durante l'acquisizione
+void adc_fast_start(volatile int16_t *buf, int n, unsigned int hz);
+int adc_fast_done(void);
+void adc_fast_stop(void);
@@ -1 +1,11 @@
-void audio_init(void);
\ No newline at end of file
+#ifndef AUDIO_PMW_H
+#define AUDIO_PMW_H
+
+#define AUDIO_FREQ 10000 // frequenza del beep
+// T_pwm = ((PR+1)*Presc)/PBCLK --> (PR+1) = (PBCLK / Freq_pwm) * Presc
+#define AUDIO_PR(pbclk) ((pbclk) / AUDIO_FREQ - 1)
+
+void audio_init(void);
+void audio_clock_changed(unsigned int pbclk);
+
+#endif // AUDIO_PMW_H
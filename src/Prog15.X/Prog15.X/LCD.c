@@ -1,58 +1,101 @@
-#include "LCD.h"
-#include "Timer.h"
-#include <p32xxxx.h>
-
-void initLCD( void)
-{
-    ANSELE = 0x0000; //RE0:7 as digital
-    TRISE = 0x00FF; // RE0:7 as digital input , or 0x0000 as out is the same
-    TRISDbits.TRISD4 = 0; // RD4 as digital output ENpin
-    TRISDbits.TRISD5 = 0; // RD5 as digital output RWpin
-    ANSELBbits.ANSB15 = 0; //RB15 ad digital
-    TRISBbits.TRISB15 = 0;  // RB15 as digital output RSpin
-    
-    // PMP initialization
-    PMCON = 0x83BF; // Enable the PMP, long waits
-    PMMODE = 0x3FF; // Master Mode 1
-    PMAEN = 0x0001; // PMA0 enabled
-    // wait for >30ms
-    Delayms(30); // Timer configured before externally (i.e. you can use T1 for 1ms interrupt reset)
-    PMADDR = LCDCMD; // command register (ADDR = 0)
-    PMDATA = 0x38; // set: 8-bit interface, 2 lines, 5x7
-    Delayms(1); //>48us
-    PMDATA = 0x0c; // ON, no cursor, no blink
-    Delayms(1); //>48us
-    PMDATA = 0x01; // clear display
-    Delayms(2); //>1.6ms
-    PMDATA = 0x06; // increment cursor, no shift
-    Delayms(2); //>1.6ms
-} // initLCD
-
-
-char readLCD( int addr)
-{
-    int dummy;
-    while( PMMODEbits.BUSY){} // wait for PMP to be available
-    PMADDR = addr; // select the command address
-    dummy = PMDATA; // init read cycle, dummy read
-    while( PMMODEbits.BUSY){} // wait for PMP to be available
-    return( PMDATA); // read the status register
-} // readLCD
-
-void writeLCD( int addr, char c)
-{
-    Delayms(1);
-    while( busyLCD()){} // wait for LCD driver (KSUU06) to be available
-    while( PMMODEbits.BUSY){} // wait for PMP to be available
-    PMADDR = addr;
-    PMDATA = c;
-} // writeLCD
-
-void putsLCD( char *s)
-{
-    while( *s)
-    {
-        putLCD( *s++);
-    }
-} //putsLCD
-
+#include "LCD.h"
+#include "Timer.h"
+#include "drv.h"
+#include <p32xxxx.h>
+
+static int lcd_init_state = 0;
+static unsigned int lcd_init_time = 0;
+static unsigned int lcd_init_wait = 0;
+
+// One step of the init sequence, waits are checked against the 1ms tick
+// (Timer1) instead of blocking. Returns 1 when the LCD is ready
+int initLCD_step( void)
+{
+    if( millis() - lcd_init_time <= lcd_init_wait)
+        return 0; // strictly greater: at least lcd_init_wait ms elapsed
+    
+    switch( lcd_init_state)
+    {
+    case 0:
+        ANSELE = 0x0000; //RE0:7 as digital
+        TRISE = 0x00FF; // RE0:7 as digital input , or 0x0000 as out is the same
+        TRISDbits.TRISD4 = 0; // RD4 as digital output ENpin
+        TRISDbits.TRISD5 = 0; // RD5 as digital output RWpin
+        ANSELBbits.ANSB15 = 0; //RB15 ad digital
+        TRISBbits.TRISB15 = 0;  // RB15 as digital output RSpin
+        
+        // PMP initialization
+        PMCON = 0x83BF; // Enable the PMP, long waits
+        PMMODE = 0x3FF; // Master Mode 1
+        PMAEN = 0x0001; // PMA0 enabled
+        lcd_init_wait = 30; // wait for >30ms
+        break;
+    case 1:
+        PMADDR = LCDCMD; // command register (ADDR = 0)
+        PMDATA = 0x38; // set: 8-bit interface, 2 lines, 5x7
+        lcd_init_wait = 1; //>48us
+        break;
+    case 2:
+        PMDATA = 0x0c; // ON, no cursor, no blink
+        lcd_init_wait = 1; //>48us
+        break;
+    case 3:
+        PMDATA = 0x01; // clear display
+        lcd_init_wait = 2; //>1.6ms
+        break;
+    case 4:
+        PMDATA = 0x06; // increment cursor, no shift
+        lcd_init_wait = 2; //>1.6ms
+        break;
+    default:
+        return 1;
+    }
+    lcd_init_time = millis();
+    lcd_init_state++;
+    return 0;
+} // initLCD_step
+
+void initLCD( void)
+{
+    lcd_init_state = 0;
+    lcd_init_wait = 0;
+    while( !initLCD_step()){} // Timer1 must be running
+} // initLCD
+
+
+// All waits are bounded by LCD_TIMEOUT_US. On timeout readLCD returns 0xFF
+// (busy flag set), so a missing display makes writeLCD fail instead of hang
+char readLCD( int addr)
+{
+    int dummy;
+    if( WAIT_WHILE( PMMODEbits.BUSY, LCD_TIMEOUT_US, lcd_stats) != DRV_OK) // wait for PMP to be available
+        return 0xFF;
+    PMADDR = addr; // select the command address
+    dummy = PMDATA; // init read cycle, dummy read
+    if( WAIT_WHILE( PMMODEbits.BUSY, LCD_TIMEOUT_US, lcd_stats) != DRV_OK) // wait for PMP to be available
+        return 0xFF;
+    return( PMDATA); // read the status register
+} // readLCD
+
+int writeLCD( int addr, char c)
+{
+    Delayms(1);
+    if( WAIT_WHILE( busyLCD(), LCD_TIMEOUT_US, lcd_stats) != DRV_OK) // wait for LCD driver (KSUU06) to be available
+        return DRV_TIMEOUT;
+    if( WAIT_WHILE( PMMODEbits.BUSY, LCD_TIMEOUT_US, lcd_stats) != DRV_OK) // wait for PMP to be available
+        return DRV_TIMEOUT;
+    PMADDR = addr;
+    PMDATA = c;
+    return DRV_OK;
+} // writeLCD
+
+int putsLCD( char *s)
+{
+    while( *s)
+    {
+        if( putLCD( *s++) != DRV_OK)
+            return DRV_TIMEOUT;
+    }
+    return DRV_OK;
+} //putsLCD
+
@@ -1,11 +1,11 @@
-/* 
- * File:   Pin.h
- * Author: giada
- *
- * Created on October 7, 2024, 4:31 PM
- */
-void Init_pins();
-void outputConfig (void);
-
-void outputConfigSwitch();
-
+/* 
+ * File:   Pin.h
+ * Author: giada
+ *
+ * Created on October 7, 2024, 4:31 PM
+ */
+void Init_pins();
+void outputConfig (void);
+
+void outputConfigSwitch();
+
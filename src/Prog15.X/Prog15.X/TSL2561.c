@@ -1,130 +1,171 @@
-#include "TSL2561.h"
-#include "i2c.h"
-#include "Uart.h"  // La libreria I2C e la UART sono necessarie per il funzionamento
-#include <math.h>  // Per la funzione powf()
-#include <stdint.h>
-#include <stdio.h> // Per la funzione snprintf()
-#include "Timer.h"
-
-// Optional: se hai bisogno di una funzione di delay (es. Delayms(500))
-extern void Delayms(unsigned int t);
-
-// Definizione dell'indirizzo I2C del sensore TSL2561
-#define TSL2561_ADDR 0x29
-
-// Registri del TSL2561
-#define TSL2561_REG_CONTROL   0x00
-#define TSL2561_REG_TIMING    0x01
-#define TSL2561_REG_DATA0LOW  0x0C
-#define TSL2561_REG_DATA0HIGH 0x0D
-#define TSL2561_REG_DATA1LOW  0x0E
-#define TSL2561_REG_DATA1HIGH 0x0F
-#define TSL2561_REG_ID        0x0A
-
-// Comandi per il controllo di accensione/spegnimento
-#define TSL2561_POWER_ON  0x03
-#define TSL2561_POWER_OFF 0x00
-
-// Funzione per leggere un canale del sensore (canale 0 o canale 1)
-static uint16_t TSL2561_read_channel(uint8_t reg_low, uint8_t reg_high) {
-    uint8_t low, high;
-
-    // Avvia la comunicazione I2C
-    i2c_master_start();
-    i2c_master_send(TSL2561_ADDR << 1);  // Invia indirizzo I2C (scrittura)
-    i2c_master_send(TSL2561_CMD | reg_low);  // Invia il registro da leggere
-
-    // Ripristina per la lettura
-    i2c_master_restart();
-    i2c_master_send((TSL2561_ADDR << 1) | 1);  // Invia indirizzo I2C (lettura)
-
-    // Legge i due byte (low e high)
-    low  = i2c_master_recv(0);  // Legge il byte basso (ack)
-    high = i2c_master_recv(1);  // Legge il byte alto (Nack)
-
-    i2c_master_stop();
-
-    return ((uint16_t)high << 8) | low;
-}
-
-// Funzione per inizializzare il sensore TSL2561
-void TSL2561_init(void) {
-    // Accendi il sensore (comando di accensione)
-    i2c_master_start();
-    i2c_master_send(TSL2561_ADDR << 1);
-    i2c_master_send(TSL2561_CMD | TSL2561_REG_CONTROL);  // Registro di controllo
-    i2c_master_send(TSL2561_POWER_ON);
-    i2c_master_stop();
-
-    // Attendi che il sensore si accenda completamente
-    Delayms(200);
-
-    // Imposta il tempo di integrazione a 402 ms (valore 0x02)
-    i2c_master_start();
-    i2c_master_send(TSL2561_ADDR << 1);
-    i2c_master_send(TSL2561_CMD | TSL2561_REG_TIMING);  // Registro di timing
-    i2c_master_send(0x11);  // Imposta 402 ms di integrazione
-    i2c_master_stop();
-
-    // Attendi il completamento dell'integrazione
-    Delayms(500);
-}
-
-// Funzione per leggere l'ID del sensore TSL2561
-uint8_t TSL2561_read_id(void) {
-    uint8_t id = 0;
-
-    // Avvia la comunicazione I2C per leggere l'ID
-    i2c_master_start();
-    i2c_master_send(TSL2561_ADDR << 1);
-    i2c_master_send(TSL2561_CMD | TSL2561_REG_ID);  // Registro ID
-
-    // Ripristina per la lettura dell'ID
-    i2c_master_restart();
-    i2c_master_send((TSL2561_ADDR << 1) | 1);  // Invia indirizzo I2C per lettura
-
-    // Leggi l'ID del sensore
-    id = i2c_master_recv(1);  // Leggi un byte (NACK dopo)
-
-    i2c_master_stop();
-
-    return id;
-}
-
-// Funzione per leggere i dati di luce (lux) dal sensore
-unsigned int TSL2561_read_lux(void) {
-    uint16_t CH0 = TSL2561_read_channel(TSL2561_REG_DATA0LOW, TSL2561_REG_DATA0HIGH);  // Canale 0
-    uint16_t CH1 = TSL2561_read_channel(TSL2561_REG_DATA1LOW, TSL2561_REG_DATA1HIGH); // Canale 1
-    
-    if (CH0 == 0xFFFF || CH1 == 0xFFFF || CH0 > 65535 || CH1 > 65535) {
-        UART4_WriteString("Sensore saturato o errore nella lettura.\r\n");
-        return 0;
-    }
- 
-    // Calcola il rapporto tra i canali e determina il valore di lux
-    float ratio = (float)CH1 / (float)CH0;
-
-    float lux = 0.0f;
-
-    // Calcolo dei lux in base al rapporto
-    if (ratio <= 0.5f) {
-        lux = 0.0304f * CH0 - 0.062f * CH0 * powf(ratio, 1.4f);
-    } else if (ratio <= 0.61f) {
-        lux = 0.0224f * CH0 - 0.031f * CH1;
-    } else if (ratio <= 0.80f) {
-        lux = 0.0128f * CH0 - 0.0153f * CH1;
-    } else if (ratio <= 1.30f) {
-        lux = 0.00146f * CH0 - 0.00112f * CH1;
-    } else {
-        lux = 0.0f;
-    }
-
-    // Evita valori negativi
-    if (lux < 0.0f) {
-        lux = 0.0f;
-    }
-    
-    Delayms(500);
-    return (unsigned int)lux;
-}
-
+#include "TSL2561.h"
+#include "i2c.h"
+#include "i2cbus.h"
+#include "Uart.h"  // La libreria I2C e la UART sono necessarie per il funzionamento
+#include <math.h>  // Per la funzione powf()
+#include <stdint.h>
+#include <stdio.h> // Per la funzione snprintf()
+#include "Timer.h"
+#include "drv.h"
+
+// Optional: se hai bisogno di una funzione di delay (es. Delayms(500))
+extern void Delayms(unsigned int t);
+
+// Definizione dell'indirizzo I2C del sensore TSL2561
+#define TSL2561_ADDR 0x29
+
+// Registri del TSL2561
+#define TSL2561_REG_CONTROL   0x00
+#define TSL2561_REG_TIMING    0x01
+#define TSL2561_REG_DATA0LOW  0x0C
+#define TSL2561_REG_DATA0HIGH 0x0D
+#define TSL2561_REG_DATA1LOW  0x0E
+#define TSL2561_REG_DATA1HIGH 0x0F
+#define TSL2561_REG_ID        0x0A
+
+// Comandi per il controllo di accensione/spegnimento
+#define TSL2561_POWER_ON  0x03
+#define TSL2561_POWER_OFF 0x00
+
+// Funzione per leggere un canale del sensore (canale 0 o canale 1)
+static int TSL2561_read_channel(uint8_t reg_low, uint16_t *value) {
+    uint8_t data[2];
+
+    // Legge i due byte (low e high) con restart
+    int status = i2cbus_read(I2CBUS_TSL2561, TSL2561_ADDR, TSL2561_CMD | reg_low, data, 2);
+    if (status != DRV_OK)
+        return status;
+
+    *value = ((uint16_t)data[1] << 8) | data[0];
+    return DRV_OK;
+}
+
+static int init_state = 0;
+static int init_retries = 0;
+static unsigned int init_time = 0;
+static uint8_t timing = TSL2561_TIMING_DEFAULT;
+
+void TSL2561_set_timing(uint8_t value) {
+    if (TSL2561_TIMING_VALID(value))
+        timing = value;
+}
+
+unsigned int TSL2561_integ_ms(void) {
+    static const unsigned int integ_ms[3] = { 20, 110, 420 }; // 13.7, 101, 402 ms
+    return integ_ms[timing & 0x03];
+}
+
+unsigned int TSL2561_gain(void) {
+    return (timing & 0x10) ? 16 : 1;
+}
+
+// Inizializzazione a passi, senza attese bloccanti: ritorna 1 quando
+// il primo ciclo di integrazione è completo e il sensore può essere letto.
+// Se il sensore non risponde riprova ogni TSL2561_RETRY_MS, poi rinuncia
+// (le letture successive ritorneranno errore)
+int TSL2561_init_step(void) {
+    unsigned char value;
+
+    switch (init_state) {
+    case 0:
+        if (init_retries && millis() - init_time <= TSL2561_RETRY_MS)
+            return 0;
+        init_time = millis();
+
+        // Accendi il sensore (comando di accensione)
+        value = TSL2561_POWER_ON;
+        if (i2cbus_write(I2CBUS_TSL2561, TSL2561_ADDR, TSL2561_CMD | TSL2561_REG_CONTROL, &value, 1) != DRV_OK)
+            return ++init_retries >= TSL2561_INIT_RETRIES;
+
+        // Guadagno e integrazione. L'integrazione parte subito dopo
+        // l'accensione, non serve attendere prima di questa scrittura
+        value = timing;
+        if (i2cbus_write(I2CBUS_TSL2561, TSL2561_ADDR, TSL2561_CMD | TSL2561_REG_TIMING, &value, 1) != DRV_OK)
+            return ++init_retries >= TSL2561_INIT_RETRIES;
+
+        init_state = 1;
+        return 0;
+    case 1:
+        // Attendi il completamento della prima integrazione
+        if (millis() - init_time <= TSL2561_INTEG_MS)
+            return 0;
+        init_state = 2;
+        return 1;
+    default:
+        return 1;
+    }
+}
+
+// Funzione per inizializzare il sensore TSL2561
+void TSL2561_init(void) {
+    init_state = 0;
+    init_retries = 0;
+    while (!TSL2561_init_step()) { ; }
+}
+
+// Funzione per leggere l'ID del sensore TSL2561 (0 se non risponde)
+uint8_t TSL2561_read_id(void) {
+    uint8_t id = 0;
+
+    if (i2cbus_read(I2CBUS_TSL2561, TSL2561_ADDR, TSL2561_CMD | TSL2561_REG_ID, &id, 1) != DRV_OK)
+        return 0;
+    return id;
+}
+
+// Funzione per leggere i valori grezzi dei due canali, ritorna DRV_OK o un
+// codice di errore I2C
+int TSL2561_read_channels(uint16_t *ch0, uint16_t *ch1) {
+    int status = TSL2561_read_channel(TSL2561_REG_DATA0LOW, ch0);  // Canale 0
+    if (status != DRV_OK)
+        return status;
+    return TSL2561_read_channel(TSL2561_REG_DATA1LOW, ch1); // Canale 1
+}
+
+// Funzione per leggere i dati di luce (lux) dal sensore
+unsigned int TSL2561_read_lux(void) {
+    uint16_t CH0, CH1;
+
+    if (TSL2561_read_channels(&CH0, &CH1) != DRV_OK || TSL2561_SATURATED(CH0, CH1)) {
+        UART4_WriteString("Sensore saturato o errore nella lettura.\r\n");
+        return 0;
+    }
+    return TSL2561_calc_lux(CH0, CH1);
+}
+
+// Calcola i lux dai valori grezzi dei canali (0 se saturato)
+unsigned int TSL2561_calc_lux(uint16_t CH0, uint16_t CH1) {
+    if (TSL2561_SATURATED(CH0, CH1)) {
+        return 0;
+    }
+ 
+    // Calcola il rapporto tra i canali e determina il valore di lux
+    float ratio = (float)CH1 / (float)CH0;
+
+    float lux = 0.0f;
+
+    // Calcolo dei lux in base al rapporto
+    if (ratio <= 0.5f) {
+        lux = 0.0304f * CH0 - 0.062f * CH0 * powf(ratio, 1.4f);
+    } else if (ratio <= 0.61f) {
+        lux = 0.0224f * CH0 - 0.031f * CH1;
+    } else if (ratio <= 0.80f) {
+        lux = 0.0128f * CH0 - 0.0153f * CH1;
+    } else if (ratio <= 1.30f) {
+        lux = 0.00146f * CH0 - 0.00112f * CH1;
+    } else {
+        lux = 0.0f;
+    }
+
+    // Evita valori negativi
+    if (lux < 0.0f) {
+        lux = 0.0f;
+    }
+
+    // Coefficienti tarati a 16x e 101 ms: riporta gli altri timing alla
+    // stessa scala
+    static const float integ_scale[3] = { 101.0f / 13.7f, 1.0f, 101.0f / 402.0f };
+    lux *= integ_scale[timing & 0x03] * (16.0f / TSL2561_gain());
+    
+    return (unsigned int)lux;
+}
+
@@ -1,30 +1,56 @@
-#ifndef TSL2561_H
-#define TSL2561_H
-
-#include <stdint.h>  // Aggiungi questa linea per i tipi uint8_t e uint16_t
-
-// Indirizzo I2C del sensore TSL2561
-#define TSL2561_ADDR 0x39
-
-// Comandi per l'accesso ai registri del sensore TSL2561
-#define TSL2561_CMD 0xA0
-#define TSL2561_REG_CONTROL 0x00
-#define TSL2561_REG_TIMING 0x01
-#define TSL2561_REG_DATA0LOW 0x0C
-#define TSL2561_REG_DATA0HIGH 0x0D
-
-// Comandi di controllo
-#define TSL2561_POWER_ON 0x03
-#define TSL2561_POWER_OFF 0x00
-
-// Funzione di inizializzazione del sensore
-void TSL2561_init(void);
-
-// Funzione per leggere i dati grezzi dal sensore
-uint16_t TSL2561_read_raw(void);
-
-// Funzione per leggere il valore luminoso in Lux
-unsigned int TSL2561_read_lux(void);
-uint8_t TSL2561_read_id(void);  // Aggiungi il prototipo della funzione
-
-#endif // TSL2561_H
+#ifndef TSL2561_H
+#define TSL2561_H
+
+#include <stdint.h>  // Aggiungi questa linea per i tipi uint8_t e uint16_t
+
+// Indirizzo I2C del sensore TSL2561
+#define TSL2561_ADDR 0x39
+
+// Comandi per l'accesso ai registri del sensore TSL2561
+#define TSL2561_CMD 0xA0
+#define TSL2561_REG_CONTROL 0x00
+#define TSL2561_REG_TIMING 0x01
+#define TSL2561_REG_DATA0LOW 0x0C
+#define TSL2561_REG_DATA0HIGH 0x0D
+
+// Comandi di controllo
+#define TSL2561_POWER_ON 0x03
+#define TSL2561_POWER_OFF 0x00
+
+// Registro di timing: guadagno 16x (bit 4), integrazione (INTEG, bit 1-0)
+// 13.7, 101 o 402 ms; INTEG = 11 è il modo manuale, non usato.
+// Il valore è l'impostazione "tsl_timing" (settings.h)
+#define TSL2561_TIMING_DEFAULT 0x11 // 16x, 101 ms
+#define TSL2561_TIMING_VALID(t) (((t) & ~0x13) == 0 && ((t) & 0x03) != 0x03)
+#define TSL2561_INIT_RETRIES 5
+#define TSL2561_RETRY_MS 100
+// Integrazione più margine per la tolleranza dell'oscillatore, e guadagno
+#define TSL2561_INTEG_MS TSL2561_integ_ms()
+#define TSL2561_GAIN TSL2561_gain()
+
+// Un canale a fondo scala indica saturazione o errore di lettura
+#define TSL2561_SATURATED(ch0, ch1) ((ch0) == 0xFFFF || (ch1) == 0xFFFF)
+
+// Registro di timing scritto dall'inizializzazione (da chiamare prima)
+void TSL2561_set_timing(uint8_t timing);
+unsigned int TSL2561_integ_ms(void);
+unsigned int TSL2561_gain(void);
+
+// Funzione di inizializzazione del sensore
+void TSL2561_init(void);
+
+// Un passo dell'inizializzazione non bloccante, ritorna 1 a sensore pronto
+int TSL2561_init_step(void);
+
+// Funzione per leggere i dati grezzi dal sensore
+uint16_t TSL2561_read_raw(void);
+
+// Funzione per leggere il valore luminoso in Lux
+unsigned int TSL2561_read_lux(void);
+
+// Lettura dei due canali grezzi e calcolo dei lux separati
+int TSL2561_read_channels(uint16_t *ch0, uint16_t *ch1);
+unsigned int TSL2561_calc_lux(uint16_t CH0, uint16_t CH1);
+uint8_t TSL2561_read_id(void);  // Aggiungi il prototipo della funzione
+
+#endif // TSL2561_H
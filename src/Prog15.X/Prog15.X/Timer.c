@@ -1,42 +1,102 @@
-/* 
- * File:   Timer.c
- * Author: giada
- *
- * Created on November 4, 2024, 3:38 PM
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <p32xxxx.h>
-
-/*
- * 
- */
-//If you set timer reset every 1ms, you can use Delayms as shown below. Pass ms as argument you want to wait
-void Delayms(unsigned t){
-    while (t--)
-    { // t x 1ms loop
-		TMR2 = 0; // manually reset TMR2 register to guarantee time elaplsing desidered
-		while (TMR2 < PR2);
-    }
-} 
-
-void Timer2_init(void)
-{
-    T2CONbits.ON = 0;   // Disable Timer2
-    T2CONbits.T32 = 0;  // not use 32-bit mode - use 16-bit mode
-    T2CONbits.TCKPS = 0b111; //or 0x7, select prescaler 256
-    T2CONbits.TCS = 0;  //select internal peripheral clock
-    TMR2 = 0;           //Clear TMR2 register
-    PR2 = 78;        // Set PR2 register - Calculated to have 0.001s (1ms)- Change it for new delays (See also PBCLK due to #pragma)
-    
-    /* avvio timer2 */
-    T2CONbits.ON = 1;   // Enable Timer2  T2CONbits.TCKPS = 0b111; //select prescaler 256    
-}
-
-void MultiVector_mode()
-{
-	__builtin_disable_interrupts();
-	INTCONbits.MVEC = 1;
-	__builtin_enable_interrupts();
-}
+/* 
+ * File:   Timer.c
+ * Author: giada
+ *
+ * Created on November 4, 2024, 3:38 PM
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <p32xxxx.h>
+#include "Timer.h"
+#include "button.h"
+#include "events.h"
+#include "clock.h"
+#include "mem.h"
+
+static volatile unsigned int tick_ms = 0;       // ms dall'avvio
+static volatile unsigned int event_period = 0;  // periodo di EV_TIMER (0 = disattivo)
+static volatile unsigned int event_count = 0;
+
+/*
+ * 
+ */
+//If you set timer reset every 1ms, you can use Delayms as shown below. Pass ms as argument you want to wait
+void Delayms(unsigned t){
+    while (t--)
+    { // t x 1ms loop
+		TMR2 = 0; // manually reset TMR2 register to guarantee time elaplsing desidered
+		while (TMR2 < PR2);
+    }
+} 
+
+void Timer2_init(void)
+{
+    T2CONbits.ON = 0;   // Disable Timer2
+    T2CONbits.T32 = 0;  // not use 32-bit mode - use 16-bit mode
+    T2CONbits.TCKPS = 0b111; //or 0x7, select prescaler 256
+    T2CONbits.TCS = 0;  //select internal peripheral clock
+    TMR2 = 0;           //Clear TMR2 register
+    PR2 = TIMER2_PR(clock_pbclk()); // 0.001s (1ms), 78 con PBCLK = 20MHz
+    
+    /* avvio timer2 */
+    T2CONbits.ON = 1;   // Enable Timer2  T2CONbits.TCKPS = 0b111; //select prescaler 256    
+}
+
+// Timer1 come tick di sistema da 1ms con interrupt
+void Timer1_init(void)
+{
+    T1CONbits.ON = 0;   // Disable Timer1
+    T1CONbits.TCKPS = 1; // prescaler 8
+    T1CONbits.TCS = 0;  // select internal peripheral clock
+    TMR1 = 0;
+    PR1 = TIMER1_PR(clock_pbclk()); // (PR1+1) = PBCLK / (8 * 1000) -> 1ms
+    
+    IPC1bits.T1IP = 1;  // Stessa priorità degli altri produttori di eventi
+    IPC1bits.T1IS = 0;
+    IFS0bits.T1IF = 0;
+    IEC0bits.T1IE = 1;
+    
+    T1CONbits.ON = 1;   // Enable Timer1
+}
+
+void __attribute__((interrupt(ipl1AUTO), vector(_TIMER_1_VECTOR))) Timer1Interrupt(void)
+{
+    MEM_ISR_PROBE();
+    tick_ms++;
+    button_debounce_tick();
+    if (event_period && ++event_count >= event_period) {
+        event_count = 0;
+        event_push(EV_TIMER, 0);
+    }
+    IFS0bits.T1IF = 0;
+}
+
+// Ricalcola i periodi dopo un cambio di clock
+void Timer_clock_changed(unsigned int pbclk)
+{
+    PR1 = TIMER1_PR(pbclk);
+    if (TMR1 > PR1)
+        TMR1 = 0;   // altrimenti il contatore arriverebbe fino a 0xFFFF
+    PR2 = TIMER2_PR(pbclk);
+}
+
+unsigned int millis(void)
+{
+    return tick_ms;
+}
+
+// Genera un evento EV_TIMER ogni ms millisecondi (0 per disattivarlo)
+void Timer1_set_event_period(unsigned ms)
+{
+    event_period = 0;
+    event_count = 0;
+    event_period = ms;
+}
+
+void MultiVector_mode()
+{
+	__builtin_disable_interrupts();
+	INTCONbits.MVEC = 1;
+	__builtin_enable_interrupts();
+}
@@ -1,11 +1,19 @@
-/* 
- * File:   Timer.h
- * Author: giada
- *
- * Created on November 4, 2024, 3:44 PM
- */
-
-void Timer2_init(void);
-void Delayms( unsigned t);
-void MultiVector_mode(void);
-
+/* 
+ * File:   Timer.h
+ * Author: giada
+ *
+ * Created on November 4, 2024, 3:44 PM
+ */
+
+// Periodi per il tick da 1ms in funzione del PBCLK
+#define TIMER1_PR(pbclk) ((pbclk) / 8 / 1000 - 1)   // prescaler 8
+#define TIMER2_PR(pbclk) ((pbclk) / 256 / 1000)     // prescaler 256, Delayms conta fino a PR2
+
+void Timer2_init(void);
+void Delayms( unsigned t);
+void MultiVector_mode(void);
+void Timer1_init(void);
+unsigned int millis(void);
+void Timer1_set_event_period(unsigned ms);
+void Timer_clock_changed(unsigned int pbclk);
+
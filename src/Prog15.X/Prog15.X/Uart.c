@@ -1,101 +1,192 @@
-/* 
- * File:   Uart.c
- * Author: giada
- *
- * Created on October 3, 2024, 3:47 PM
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <p32xxxx.h>
-#include "Uart.h"
-#include "Timer.h"
-
-/*
- * 
- */
-
-void UART_ConfigurePins(){ // used to configure UART4 TX and RX
-    TRISFbits.TRISF12 = 0 ; //TX digital output
-    RPF12R = 2 ; // 0010 U4TX = Mapping U4TX to RPF12;
-    TRISFbits.TRISF13 = 1;//RX digital  input
-    U4RXR = 9 ; // 1001 RF13 = Mapping U4RX to RPF13
-}
-
-
-void UART_ConfigureUart(){
-    remap_UART4_pins();
-    unsigned int PbusClock = 20000000;
-    unsigned int UartBrg = 0 ;
-    U4MODEbits.ON = 0 ;
-    U4MODEbits.SIDL = 0 ;
-    U4MODEbits.IREN = 0 ;
-    U4MODEbits.RTSMD = 0 ;
-    U4MODEbits.UEN0 = 0 ;
-    U4MODEbits.UEN1 = 0 ;
-    U4MODEbits.WAKE = 0 ;
-    U4MODEbits.LPBACK = 0 ;
-    U4MODEbits.ABAUD = 0 ;
-    U4MODEbits.RXINV = 0 ;
-    U4MODEbits.PDSEL1 = 0 ;
-    U4MODEbits.PDSEL0 = 0 ;
-    U4MODEbits.STSEL = 0 ;
-    U4MODEbits.BRGH = 0 ;
-    /* calculate brg */
-    UartBrg = (int) ((20000000 / (16 * 9600) - 1) + 0.5) ; // add 0.5 to round
-    U4BRG = UartBrg ;
-    U4STAbits.UTXEN = 1;
-    U4STAbits.URXEN = 1;
-    U4MODEbits.ON = 1 ;
-}
-
-void remap_UART4_pins(void) {
-   
-    U4RXR = 0b1001; // RF13 -> UART4 RX
-    RPF12R = 2; // RF12 -> UART4 TX
-}
-
-int putU4 (char c){
-    while(U4STAbits.UTXBF == 1); // 1 = occupato 
-        U4TXREG = c ;
-}
-
-char getU4 (void){
-    while (!U4STAbits.URXDA) ; // wait for a new char to arrive
-        return U4RXREG; // read char from receive buffer
-}
-
-void putU4_string (char szData[ ]){
-    char *pData = szData;
-    while (*pData){
-        putU4((*(pData++))) ;
-    }
-}
-
-void UART4_WriteString(const char *str) {
-    while (*str) {
-        putU4(*str++);
-    }
-}
-
-
-void UART4_ReadString(char* buffer, int maxLength) {
-    int i = 0;
-    char c;
-    while (i < maxLength - 1) {
-        c = getU4();
-        if (c == '\n' || c == '\r') break;  // Fine riga
-        buffer[i++] = c;
-    }
-    buffer[i] = '\0';  // Termina la stringa
-}
-
-int isU4Available(void) {
-    return U4STAbits.URXDA;  // Returns 1 if data is available, 0 otherwise
-}
-
-void UART4_FlushBuffer() {
-    while (isU4Available()) {
-        getU4();  // Consume all leftover characters
-    }
+/* 
+ * File:   Uart.c
+ * Author: giada
+ *
+ * Created on October 3, 2024, 3:47 PM
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <p32xxxx.h>
+#include "Uart.h"
+#include "Timer.h"
+#include "events.h"
+#include "clock.h"
+#include "drv.h"
+#include "mem.h"
+
+/*
+ * 
+ */
+
+void UART_ConfigurePins(){ // used to configure UART4 TX and RX
+    TRISFbits.TRISF12 = 0 ; //TX digital output
+    RPF12R = 2 ; // 0010 U4TX = Mapping U4TX to RPF12;
+    TRISFbits.TRISF13 = 1;//RX digital  input
+    U4RXR = 9 ; // 1001 RF13 = Mapping U4RX to RPF13
+}
+
+
+static unsigned int uart_baud = UART_BAUD;
+
+void UART_ConfigureUart(){
+    remap_UART4_pins();
+    unsigned int UartBrg = 0 ;
+    U4MODEbits.ON = 0 ;
+    U4MODEbits.SIDL = 0 ;
+    U4MODEbits.IREN = 0 ;
+    U4MODEbits.RTSMD = 0 ;
+    U4MODEbits.UEN0 = 0 ;
+    U4MODEbits.UEN1 = 0 ;
+    U4MODEbits.WAKE = 0 ;
+    U4MODEbits.LPBACK = 0 ;
+    U4MODEbits.ABAUD = 0 ;
+    U4MODEbits.RXINV = 0 ;
+    U4MODEbits.PDSEL1 = 0 ;
+    U4MODEbits.PDSEL0 = 0 ;
+    U4MODEbits.STSEL = 0 ;
+    U4MODEbits.BRGH = 0 ;
+    /* calculate brg */
+    UartBrg = UART_BRG(clock_pbclk(), uart_baud) ;
+    U4BRG = UartBrg ;
+    U4STAbits.UTXEN = 1;
+    U4STAbits.URXEN = 1;
+    U4MODEbits.ON = 1 ;
+}
+
+void UART4_clock_changed(unsigned int pbclk) {
+    U4BRG = UART_BRG(pbclk, uart_baud);
+}
+
+// Cambia il baud rate dopo aver svuotato la trasmissione in corso
+void UART4_set_baud(unsigned int baud) {
+    if (!UART_BAUD_VALID(baud) || baud == uart_baud)
+        return;
+    UART4_WaitIdle();
+    uart_baud = baud;
+    U4BRG = UART_BRG(clock_pbclk(), uart_baud);
+}
+
+void remap_UART4_pins(void) {
+   
+    U4RXR = 0b1001; // RF13 -> UART4 RX
+    RPF12R = 2; // RF12 -> UART4 TX
+}
+
+int putU4 (char c){
+    if (WAIT_WHILE(U4STAbits.UTXBF == 1, UART_TIMEOUT_US, uart4_stats) != DRV_OK) // 1 = occupato 
+        return DRV_TIMEOUT;
+    U4TXREG = c ;
+    return DRV_OK;
+}
+
+// Ritorna il carattere ricevuto o DRV_TIMEOUT dopo UART_RX_TIMEOUT_US
+int getU4 (void){
+    if (WAIT_WHILE(!U4STAbits.URXDA, UART_RX_TIMEOUT_US, uart4_stats) != DRV_OK) // wait for a new char to arrive
+        return DRV_TIMEOUT;
+    return U4RXREG; // read char from receive buffer
+}
+
+void putU4_string (char szData[ ]){
+    char *pData = szData;
+    while (*pData){
+        putU4((*(pData++))) ;
+    }
+}
+
+// Attende la fine della trasmissione a interrupt (al massimo un buffer)
+static int UART4_WaitTx(void) {
+    return WAIT_WHILE(UART4_TxBusy(), UART_TX_BUFFER_TIMEOUT_US, uart4_stats);
+}
+
+void UART4_WriteString(const char *str) {
+    if (UART4_WaitTx() != DRV_OK) // non mescola i byte con la trasmissione a interrupt
+        return;
+    while (*str) {
+        if (putU4(*str++) != DRV_OK)
+            return;
+    }
+}
+
+
+void UART4_ReadString(char* buffer, int maxLength) {
+    int i = 0;
+    int c;
+    while (i < maxLength - 1) {
+        c = getU4();
+        if (c < 0 || c == '\n' || c == '\r') break;  // Fine riga o timeout
+        buffer[i++] = c;
+    }
+    buffer[i] = '\0';  // Termina la stringa
+}
+
+int isU4Available(void) {
+    return U4STAbits.URXDA;  // Returns 1 if data is available, 0 otherwise
+}
+
+void UART4_FlushBuffer() {
+    while (isU4Available()) {
+        getU4();  // Consume all leftover characters
+    }
+}
+
+// Ricezione a interrupt: ogni carattere diventa un evento EV_UART_RX.
+// Dopo l'abilitazione getU4()/UART4_ReadString() non vanno piu' usate
+void UART4_EnableRxInterrupt(void) {
+    UART4_FlushBuffer();
+    U4STAbits.URXISEL = 0;  // interrupt a ogni carattere ricevuto
+    IPC9bits.U4IP = 1;      // Stessa priorità degli altri produttori di eventi
+    IPC9bits.U4IS = 0;
+    IFS2bits.U4RXIF = 0;
+    IEC2bits.U4RXIE = 1;
+}
+
+// Trasmissione a interrupt di un buffer che resta valido fino al termine
+static const char * volatile tx_ptr;
+static volatile int tx_count = 0;
+
+int UART4_StartTx(const char *buf, int len) {
+    if (UART4_WaitTx() != DRV_OK) // attende la trasmissione precedente
+        return DRV_TIMEOUT;
+    tx_ptr = buf;
+    tx_count = len;
+    U4STAbits.UTXISEL = 0;  // interrupt quando c'è spazio nel buffer TX
+    IPC9bits.U4IP = 1;
+    IEC2bits.U4TXIE = 1;
+    return DRV_OK;
+}
+
+// Attende che anche il registro di scorrimento sia vuoto (es. prima di
+// cambiare il baud rate)
+int UART4_WaitIdle(void) {
+    if (UART4_WaitTx() != DRV_OK)
+        return DRV_TIMEOUT;
+    return WAIT_WHILE(!U4STAbits.TRMT, UART_TIMEOUT_US, uart4_stats);
+}
+
+int UART4_TxBusy(void) {
+    return tx_count != 0;
+}
+
+void __attribute__((interrupt(ipl1AUTO), vector(_UART_4_VECTOR))) Uart4Interrupt(void) {
+    MEM_ISR_PROBE();
+    if (IFS2bits.U4RXIF) {
+        while (U4STAbits.URXDA) {
+            event_push(EV_UART_RX, U4RXREG);
+        }
+        if (U4STAbits.OERR) {
+            U4STAbits.OERR = 0; // overrun: riprende la ricezione
+        }
+        IFS2bits.U4RXIF = 0;
+    }
+    if (IEC2bits.U4TXIE && IFS2bits.U4TXIF) {
+        while (tx_count && !U4STAbits.UTXBF) {
+            U4TXREG = *tx_ptr++;
+            tx_count--;
+        }
+        if (!tx_count) {
+            IEC2bits.U4TXIE = 0;
+        }
+        IFS2bits.U4TXIF = 0;
+    }
 }
\ No newline at end of file
@@ -1,10 +1,25 @@
-void UART_ConfigurePins (void) ;
-void UART_ConfigureUart () ;
-int putU4 (char c) ;
-char getU4 (void) ;
-void putU4_string (char szData[]) ;
-void remap_UART4_pins(void);
-void UART4_WriteString(const char *str);
-void UART4_ReadString(char* buffer, int maxLength);
-void UART4_FlushBuffer(void);
-
+#define UART_BAUD 9600 // default dell'impostazione "baud" (settings.h)
+// Baud rate ammessi: errore sotto il 2% anche con PBCLK a 8 MHz
+#define UART_BAUD_VALID(b) ((b) == 9600 || (b) == 19200 || (b) == 38400)
+// Tempo massimo per svuotare un buffer di trasmissione a interrupt (il
+// più lungo è il menu, ~450 ms a 9600 baud)
+#define UART_TX_BUFFER_TIMEOUT_US 1000000
+// BRGH = 0: U4BRG = PBCLK / (16 * baud) - 1, arrotondato
+#define UART_BRG(pbclk, baud) (((pbclk) + 8 * (baud)) / (16 * (baud)) - 1)
+
+void UART_ConfigurePins (void) ;
+void UART_ConfigureUart () ;
+int putU4 (char c) ;
+int getU4 (void) ;
+void putU4_string (char szData[]) ;
+void remap_UART4_pins(void);
+void UART4_WriteString(const char *str);
+void UART4_ReadString(char* buffer, int maxLength);
+void UART4_FlushBuffer(void);
+void UART4_EnableRxInterrupt(void);
+int UART4_StartTx(const char *buf, int len);
+int UART4_WaitIdle(void);
+int UART4_TxBusy(void);
+void UART4_clock_changed(unsigned int pbclk);
+void UART4_set_baud(unsigned int baud);
+
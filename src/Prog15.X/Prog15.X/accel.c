@@ -0,0 +1,212 @@
+/*
+ * File:   accel.c
+ *
+ * Le tre funzioni dichiarate in i2c.h e la rilevazione di orientamento e
+ * manomissioni. Una lettura a burst di 6 byte da OUT_X_MSB occupa il bus
+ * per 9 byte (0.8 ms) invece dei 3 x 5 byte di tre letture separate; con
+ * una lettura ogni ACCEL_PERIOD_MS l'accelerometro usa circa il 4% del bus.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "accel.h"
+#include "i2c.h"
+#include "i2cbus.h"
+#include "stream.h"
+#include "Timer.h"
+#include "Uart.h"
+#include "drv.h"
+
+unsigned char out_x[2];
+unsigned char out_y[2];
+unsigned char out_z[2];
+int id;
+
+static const char *const orientations[6] = { "X+", "X-", "Y+", "Y-", "Z+", "Z-" };
+
+static int present = 0;
+static int active = 0;
+static int waiting = 0;         // lettura dovuta ma rinviata dall'arbitro
+static unsigned int poll_time;
+
+static int32_t mean[3];         // media mobile in Q(ACCEL_MEAN_SHIFT)
+static int have_mean = 0;
+static int orientation = -1;    // indice in orientations, -1 sconosciuto
+static int candidate = -1;
+static int stable = 0;
+static unsigned int tamper_time;
+static unsigned int tamper_mg;      // ampiezza dell'ultima manomissione
+
+static char message[48];            // segnalazione in trasmissione a interrupt
+static int notified_orientation = -1;
+static unsigned int notified_tampers = 0;
+
+static unsigned int reads = 0;
+static unsigned int deferred = 0;
+static unsigned int tampers = 0;
+
+int read_acc_id(void) {
+    unsigned char value;
+    int status = i2cbus_read(I2CBUS_ACCEL, SLAVE_ADDR, ACCEL_REG_WHO_AM_I, &value, 1);
+
+    if (status == DRV_OK)
+        id = value;
+    return status;
+}
+
+// Fondo scala e data rate si cambiano solo in standby
+int accelertometer_setup(void) {
+    unsigned char value = 0;
+    int status;
+
+    if ((status = i2cbus_write(I2CBUS_ACCEL, SLAVE_ADDR, ACCEL_REG_CTRL_REG1, &value, 1)) != DRV_OK)
+        return status;
+    value = ACCEL_FS_2G;
+    if ((status = i2cbus_write(I2CBUS_ACCEL, SLAVE_ADDR, ACCEL_REG_XYZ_DATA_CFG, &value, 1)) != DRV_OK)
+        return status;
+    value = ACCEL_CTRL_ODR_50HZ | ACCEL_CTRL_ACTIVE;
+    return i2cbus_write(I2CBUS_ACCEL, SLAVE_ADDR, ACCEL_REG_CTRL_REG1, &value, 1);
+}
+
+// X, Y e Z in una sola transazione: il registro avanza da solo da
+// OUT_X_MSB a OUT_Z_LSB
+int reac_acc_xyz(void) {
+    unsigned char data[6];
+    int status = i2cbus_read(I2CBUS_ACCEL, SLAVE_ADDR, ACCEL_REG_OUT_X_MSB, data, sizeof(data));
+
+    if (status != DRV_OK)
+        return status;
+    out_x[0] = data[0];
+    out_x[1] = data[1];
+    out_y[0] = data[2];
+    out_y[1] = data[3];
+    out_z[0] = data[4];
+    out_z[1] = data[5];
+    return DRV_OK;
+}
+
+int accel_init_step(void) {
+    if (read_acc_id() == DRV_OK && id == ACCEL_WHO_AM_I)
+        present = accelertometer_setup() == DRV_OK;
+    return 1;
+}
+
+void accel_start(void) {
+    active = present;
+    waiting = 0;
+    have_mean = 0;
+    orientation = -1;
+    notified_orientation = -1;
+    notified_tampers = tampers;
+    candidate = -1;
+    stable = 0;
+    poll_time = millis() - ACCEL_PERIOD_MS;
+    tamper_time = millis() - ACCEL_TAMPER_HOLDOFF_MS;
+}
+
+void accel_stop(void) {
+    active = 0;
+}
+
+static int16_t axis_value(const unsigned char *out) {
+    return (int16_t)((out[0] << 8) | out[1]) >> 4;
+}
+
+// Segnalazioni a interrupt e solo a seriale libera, così non fermano il
+// main loop (es. durante il menu all'avvio); in streaming la seriale
+// porta solo il CSV dei campioni e le segnalazioni vengono scartate
+static int notify_poll(void) {
+    if (stream_active()) {
+        notified_orientation = orientation;
+        notified_tampers = tampers;
+        return 0;
+    }
+    if (UART4_TxBusy())
+        return 0; // message può essere ancora in trasmissione
+    if (tampers != notified_tampers) {
+        snprintf(message, sizeof(message), "Manomissione: scossa di %u mg\r\n", tamper_mg);
+        notified_tampers = tampers;
+    } else if (orientation >= 0 && orientation != notified_orientation) {
+        snprintf(message, sizeof(message), "Orientamento: %s\r\n", orientations[orientation]);
+        notified_orientation = orientation;
+    } else {
+        return 0;
+    }
+    UART4_StartTx(message, strlen(message));
+    return 1;
+}
+
+static void process(const int16_t a[3]) {
+    int dev = 0;
+    int axis = 0;
+
+    if (!have_mean) {
+        for (int i = 0; i < 3; i++)
+            mean[i] = (int32_t)a[i] << ACCEL_MEAN_SHIFT;
+        have_mean = 1;
+    }
+    for (int i = 0; i < 3; i++) {
+        dev += abs(a[i] - (int)(mean[i] >> ACCEL_MEAN_SHIFT));
+        mean[i] += a[i] - (mean[i] >> ACCEL_MEAN_SHIFT);
+        if (abs(a[i]) > abs(a[axis]))
+            axis = i;
+    }
+
+    // Manomissione: scarto dalla media oltre la soglia, al massimo una
+    // segnalazione per ACCEL_TAMPER_HOLDOFF_MS
+    unsigned int mg = (unsigned int)dev * 1000 / ACCEL_1G;
+    if (mg > ACCEL_TAMPER_MG && millis() - tamper_time >= ACCEL_TAMPER_HOLDOFF_MS) {
+        tamper_time = millis();
+        tamper_mg = mg;
+        tampers++;
+    }
+
+    // Orientamento: asse dominante con il segno, cambia solo se resta lo
+    // stesso per ACCEL_STABLE_READS letture
+    int o = abs(a[axis]) >= ACCEL_AXIS_MIN ? 2 * axis + (a[axis] < 0) : -1;
+    if (o != candidate) {
+        candidate = o;
+        stable = 0;
+    }
+    if (o >= 0 && o != orientation && ++stable >= ACCEL_STABLE_READS)
+        orientation = o;
+}
+
+int accel_poll(void) {
+    int16_t a[3];
+
+    if (!active)
+        return 0;
+    if (millis() - poll_time < ACCEL_PERIOD_MS)
+        return notify_poll();
+    if (!i2cbus_gap(I2CBUS_ACCEL, 6)) {
+        // Lettura del TSL2561 imminente: si riprova dopo
+        if (!waiting)
+            deferred++;
+        waiting = 1;
+        return 0;
+    }
+    waiting = 0;
+    poll_time = millis();
+    if (reac_acc_xyz() != DRV_OK)
+        return 1; // errore contato nelle statistiche del bus
+    reads++;
+    a[0] = axis_value(out_x);
+    a[1] = axis_value(out_y);
+    a[2] = axis_value(out_z);
+    process(a);
+    return 1;
+}
+
+void accel_report(void) {
+    char buffer[96];
+
+    if (!present) {
+        UART4_WriteString("Accelerometro: non rilevato\r\n");
+        return;
+    }
+    snprintf(buffer, sizeof(buffer), "Accelerometro: orientamento %s, %u letture, %u rinviate, %u manomissioni\r\n",
+             orientation >= 0 ? orientations[orientation] : "-", reads, deferred, tampers);
+    UART4_WriteString(buffer);
+}
@@ -0,0 +1,48 @@
+/*
+ * File:   accel.h
+ *
+ * Accelerometro MMA8652 della BasysMX3 (SLAVE_ADDR in i2c.h) sullo stesso
+ * bus I2C1 del TSL2561. Durante il monitoraggio X, Y e Z vengono letti con
+ * una sola lettura a burst (auto-incremento dei registri) negli intervalli
+ * lasciati liberi dal sensore di luce (i2cbus.h), per rilevare
+ * orientamento della scheda e manomissioni (scosse o spostamenti).
+ */
+
+#ifndef ACCEL_H
+#define ACCEL_H
+
+// Registri
+#define ACCEL_REG_STATUS        0x00
+#define ACCEL_REG_OUT_X_MSB     0x01    // X, Y, Z: MSB e LSB, 12 bit allineati a sinistra
+#define ACCEL_REG_WHO_AM_I      0x0D
+#define ACCEL_REG_XYZ_DATA_CFG  0x0E
+#define ACCEL_REG_CTRL_REG1     0x2A
+
+#define ACCEL_WHO_AM_I          0x4A    // MMA8652
+#define ACCEL_FS_2G             0x00
+#define ACCEL_CTRL_ODR_50HZ     0x20
+#define ACCEL_CTRL_ACTIVE       0x01
+#define ACCEL_1G                1024    // conteggi per g a +-2 g
+
+#define ACCEL_PERIOD_MS         20      // una lettura per campione dell'accelerometro
+#define ACCEL_AXIS_MIN          700     // componente sotto cui nessun asse è dominante
+#define ACCEL_STABLE_READS      5       // letture con lo stesso asse per cambiare orientamento
+#define ACCEL_TAMPER_MG         250     // scarto dalla media, somma dei tre assi
+#define ACCEL_TAMPER_HOLDOFF_MS 1000
+#define ACCEL_MEAN_SHIFT        3       // media mobile esponenziale, peso 1/8
+
+// Un passo dell'inizializzazione (boot.h): l'accelerometro è opzionale,
+// ritorna sempre 1 e se non risponde le letture restano disattivate
+int accel_init_step(void);
+
+// Letture periodiche durante il monitoraggio
+void accel_start(void);
+void accel_stop(void);
+
+// Da chiamare nel main loop, ritorna 1 se ha letto l'accelerometro
+int accel_poll(void);
+
+// Stampa stato e contatori su UART
+void accel_report(void);
+
+#endif // ACCEL_H
@@ -0,0 +1,77 @@
+/* 
+ * File:   boot.c
+ * 
+ * Avvio rapido con inizializzazioni differite. I tempi sono misurati con
+ * il core timer (SYSCLK/2), che conta dal reset e non dipende dal Timer1.
+ */
+
+#include <p32xxxx.h>
+#include <stdio.h>
+#include "boot.h"
+#include "LCD.h"
+#include "TSL2561.h"
+#include "datalog.h"
+#include "accel.h"
+#include "clock.h"
+#include "drv.h"
+#include "Uart.h"
+
+typedef struct {
+    const char *name;
+    int (*step)(void); // ritorna 1 a inizializzazione completata
+} boot_task_t;
+
+static const boot_task_t tasks[BOOT_NUM_TASKS] = {
+    { "LCD", initLCD_step },
+    { "TSL2561", TSL2561_init_step },
+    { "log", datalog_init_step },
+    { "accelerometro", accel_init_step },
+};
+
+static int done[BOOT_NUM_TASKS];
+
+static struct {
+    const char *name;
+    unsigned int ms;
+} milestones[BOOT_MAX_MILESTONES];
+static int num_milestones = 0;
+
+int boot_poll(void) {
+    int all_done = 1;
+
+    for (int i = 0; i < BOOT_NUM_TASKS; i++) {
+        if (done[i])
+            continue;
+        if (tasks[i].step()) {
+            done[i] = 1;
+            boot_milestone(tasks[i].name);
+        } else {
+            all_done = 0;
+        }
+    }
+    return all_done;
+}
+
+int boot_ready(int task) {
+    return done[task];
+}
+
+void boot_milestone(const char *name) {
+    if (num_milestones >= BOOT_MAX_MILESTONES)
+        return;
+    milestones[num_milestones].name = name;
+    milestones[num_milestones].ms = core_ticks() / (clock_sysclk() / 2000);
+    num_milestones++;
+}
+
+int boot_report(void) {
+    static char buffer[BOOT_MAX_MILESTONES * 40]; // resta valido durante la trasmissione
+    int n = 0;
+
+    if (UART4_TxBusy())
+        return 0;
+    for (int i = 0; i < num_milestones; i++)
+        n += snprintf(&buffer[n], sizeof(buffer) - n, "Boot: %s %u ms\r\n", milestones[i].name, milestones[i].ms);
+    UART4_StartTx(buffer, n);
+    return 1;
+}
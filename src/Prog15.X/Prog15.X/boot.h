@@ -0,0 +1,34 @@
+/* 
+ * File:   boot.h
+ * 
+ * Avvio rapido: le inizializzazioni lente (LCD, TSL2561) avanzano a passi
+ * dal main loop, in parallelo tra loro e con il menu UART
+ */
+
+#ifndef BOOT_H
+#define BOOT_H
+
+// Inizializzazioni differite
+#define BOOT_LCD        0
+#define BOOT_SENSOR     1
+#define BOOT_LOG        2
+#define BOOT_ACCEL      3
+#define BOOT_NUM_TASKS  4
+
+#define BOOT_MAX_MILESTONES 8
+
+// Esegue un passo di ogni inizializzazione pendente, ritorna 1 quando
+// sono tutte completate
+int boot_poll(void);
+
+// 1 se l'inizializzazione indicata è completata
+int boot_ready(int task);
+
+// Registra un traguardo con il tempo trascorso dal reset
+void boot_milestone(const char *name);
+
+// Trasmette i traguardi su UART a interrupt. Ritorna 0 senza attendere
+// se la seriale è ancora occupata (es. dal menu): va richiamata più tardi
+int boot_report(void);
+
+#endif // BOOT_H
@@ -0,0 +1,56 @@
+/* 
+ * File:   button.c
+ * 
+ * BTNC su INT4. La ISR registra subito l'evento e disabilita INT4; il
+ * tick del Timer1 lo riabilita solo quando il pin e' rimasto stabile per
+ * BUTTON_DEBOUNCE_MS, cosi' i rimbalzi non generano eventi multipli e la
+ * ISR non contiene attese.
+ */
+
+#include <p32xxxx.h>
+#include <stdint.h>
+#include "button.h"
+#include "events.h"
+#include "mem.h"
+
+#define BTNC_PIN PORTFbits.RF0
+
+static volatile uint8_t debounce_count = 0;
+static volatile uint8_t last_level = 0;
+
+void BTNC_Interrupt_Init(void) {
+    INT4R = 0x04;   
+    INTCONbits.INT4EP = 0;  // Impostazione fronte di discesa
+    // Configura priorità e flag dell'interrupt
+    IPC4bits.INT4IP = 1;    // Stessa priorità degli altri produttori di eventi
+    IPC4bits.INT4IS = 0;     // EXT0 sub-priority 0
+    IFS0bits.INT4IF = 0;    // Pulisce il flag dell'interrupt
+    IEC0bits.INT4IE = 1;    // Abilita l'interrupt INT4
+}
+
+// Interrupt INT4, accoda l'evento e avvia il debounce
+void __attribute__((interrupt(ipl1AUTO), vector(_EXTERNAL_4_VECTOR))) ButtonInterrupt(void) {
+    MEM_ISR_PROBE();
+    event_push(EV_BUTTON, 0);
+    IEC0bits.INT4IE = 0;    // Ignora i rimbalzi fino a pin stabile
+    last_level = BTNC_PIN;
+    debounce_count = BUTTON_DEBOUNCE_MS;
+    IFS0bits.INT4IF = 0;  // Pulisce il flag dell'interrupt
+}
+
+void button_debounce_tick(void) {
+    if (debounce_count == 0)
+        return;
+
+    uint8_t level = BTNC_PIN;
+    if (level != last_level) {
+        // Ancora rimbalzi: ricomincia il conteggio
+        last_level = level;
+        debounce_count = BUTTON_DEBOUNCE_MS;
+        return;
+    }
+    if (--debounce_count == 0) {
+        IFS0bits.INT4IF = 0;  // Scarta i fronti arrivati durante il debounce
+        IEC0bits.INT4IE = 1;
+    }
+}
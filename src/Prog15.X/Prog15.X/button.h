@@ -0,0 +1,18 @@
+/* 
+ * File:   button.h
+ * 
+ * BTNC su INT4 con debounce a tick del Timer1
+ */
+
+#ifndef BUTTON_H
+#define BUTTON_H
+
+// Tempo (ms) in cui il pin deve restare stabile prima di riarmare INT4
+#define BUTTON_DEBOUNCE_MS 30
+
+void BTNC_Interrupt_Init(void);
+
+// Chiamata ogni 1ms dalla ISR del Timer1
+void button_debounce_tick(void);
+
+#endif // BUTTON_H
@@ -0,0 +1,306 @@
+/*
+ * File:   capture.c
+ *
+ * Cattura con trigger; la finestra pre-trigger è quella ancora presente
+ * nel ring dei campioni, senza un buffer proprio. Ogni cattura occupa un
+ * settore: i blocchi del codec dalla seconda pagina, l'header nella prima,
+ * scritto per ultimo così una cattura interrotta non risulta valida.
+ * Dopo un salvataggio i trigger automatici restano disattivati finché il
+ * ring non contiene di nuovo CAPTURE_PRE campioni nuovi: le scritture in flash
+ * restano rare anche con luce molto variabile.
+ */
+
+#include <stdio.h>
+#include "capture.h"
+#include "codec.h"
+#include "samples.h"
+#include "spi.h"
+#include "Uart.h"
+#include "drv.h"
+
+// Il lettore consuma a ogni passo del main loop: il margine copre i
+// campioni pubblicati prima del salvataggio
+#if SAMPLES_SIZE < 2 * CAPTURE_WINDOW
+#error "il ring dei campioni non contiene la finestra di cattura"
+#endif
+
+typedef struct {
+    uint8_t type;
+    uint8_t pre;
+    uint8_t post;
+    uint32_t seq;
+    uint32_t time;
+    uint16_t lux;
+    uint8_t blocks;
+} capture_header_t;
+
+static const char *trigger_names[] = { "-", "BTNC", "gradino", "CUSUM" };
+
+static sample_reader_t reader;
+static unsigned int filled = 0; // campioni dall'ultimo riarmo
+static int active = 0;
+
+// Trigger in corso (0 = armato)
+static int trigger_type = 0;
+static int pending_button = 0;
+static int pre = 0;
+static int post = 0;
+static uint32_t trigger_seq;
+static lux_record_t trigger_rec;
+
+// Rivelatori: gradino e CUSUM sulla media mobile (Q4)
+static int have_prev = 0;
+static int prev_lux;
+static int mean_q4;
+static int cusum_hi;
+static int cusum_lo;
+
+// Posizione in flash
+static int scanned = 0;
+static int next_addr = CAPTURE_START_ADDR;
+static int last_addr = -1;
+static uint32_t next_seq = 0;
+
+static unsigned int captures = 0;
+static unsigned int write_errors = 0;
+
+static codec_block_t block;
+static uint8_t page[FLASH_PAGE_SIZE];
+
+static int read_header(int addr, capture_header_t *h) {
+    if (readFlashBlock(addr, page, CAPTURE_HEADER_SIZE) != DRV_OK || page[0] != CAPTURE_MAGIC)
+        return 0;
+    h->type = page[1];
+    h->pre = page[2];
+    h->post = page[3];
+    h->seq = page[4] | (page[5] << 8) | ((uint32_t)page[6] << 16) | ((uint32_t)page[7] << 24);
+    h->time = page[8] | (page[9] << 8) | ((uint32_t)page[10] << 16) | ((uint32_t)page[11] << 24);
+    h->lux = page[12] | (page[13] << 8);
+    h->blocks = page[14];
+    return 1;
+}
+
+// Cerca la cattura con la sequenza più alta (un header per settore)
+static void scan(void) {
+    capture_header_t h;
+
+    for (int addr = CAPTURE_START_ADDR; addr < CAPTURE_END_ADDR; addr += FLASH_SECTOR_SIZE) {
+        if (read_header(addr, &h) && (last_addr < 0 || h.seq >= next_seq)) {
+            last_addr = addr;
+            next_seq = h.seq + 1;
+        }
+    }
+    if (last_addr >= 0) {
+        next_addr = last_addr + FLASH_SECTOR_SIZE;
+        if (next_addr >= CAPTURE_END_ADDR)
+            next_addr = CAPTURE_START_ADDR;
+    }
+    scanned = 1;
+}
+
+static void arm(void) {
+    trigger_type = 0;
+    pending_button = 0;
+    filled = 0;
+    have_prev = 0;
+}
+
+// Valuta i trigger automatici su un nuovo campione
+static int detect(int lux) {
+    if (!have_prev) {
+        have_prev = 1;
+        prev_lux = lux;
+        mean_q4 = lux << 4;
+        cusum_hi = cusum_lo = 0;
+        return 0;
+    }
+
+    int step = lux - prev_lux;
+    prev_lux = lux;
+    int d = lux - (mean_q4 >> 4);
+    mean_q4 += ((lux << 4) - mean_q4) >> CAPTURE_MEAN_SHIFT;
+
+    cusum_hi += d - CAPTURE_CUSUM_DRIFT;
+    if (cusum_hi < 0)
+        cusum_hi = 0;
+    cusum_lo += -d - CAPTURE_CUSUM_DRIFT;
+    if (cusum_lo < 0)
+        cusum_lo = 0;
+
+    // Nessun trigger automatico finché la finestra pre-trigger non è piena
+    if (filled < CAPTURE_PRE)
+        return 0;
+    if (step > CAPTURE_STEP_LUX || step < -CAPTURE_STEP_LUX)
+        return CAPTURE_TRIG_STEP;
+    if (cusum_hi > CAPTURE_CUSUM_THRESHOLD || cusum_lo > CAPTURE_CUSUM_THRESHOLD)
+        return CAPTURE_TRIG_CUSUM;
+    return 0;
+}
+
+static int write_block(int addr) {
+    return writeFlashPage(addr, block.buf, block.length);
+}
+
+// Salva la finestra: pre campioni prima del trigger e post da lì in poi
+static void commit(void) {
+    char buffer[64];
+    int n = pre + post;
+    uint32_t first = trigger_seq - pre;
+    int addr = next_addr + FLASH_PAGE_SIZE;
+    int status = EraseSector(next_addr);
+    uint8_t blocks = 0;
+
+    codec_block_init(&block, next_seq);
+    for (int i = 0; i < n && status == DRV_OK; i++) {
+        const sample_t *r = samples_at(first + i);
+        if (!r)
+            continue; // già sovrascritto, non succede con SAMPLES_SIZE >= 2 finestre
+        if (!codec_block_add(&block, r->lux, r->time)) {
+            status = write_block(addr);
+            addr += FLASH_PAGE_SIZE;
+            blocks++;
+            codec_block_init(&block, next_seq);
+            codec_block_add(&block, r->lux, r->time);
+        }
+    }
+    if (status == DRV_OK) {
+        status = write_block(addr);
+        blocks++;
+    }
+    if (status == DRV_OK) {
+        page[0] = CAPTURE_MAGIC;
+        page[1] = trigger_type;
+        page[2] = pre;
+        page[3] = post;
+        page[4] = next_seq & 0xFF;
+        page[5] = (next_seq >> 8) & 0xFF;
+        page[6] = (next_seq >> 16) & 0xFF;
+        page[7] = next_seq >> 24;
+        page[8] = trigger_rec.time & 0xFF;
+        page[9] = (trigger_rec.time >> 8) & 0xFF;
+        page[10] = (trigger_rec.time >> 16) & 0xFF;
+        page[11] = trigger_rec.time >> 24;
+        page[12] = trigger_rec.lux & 0xFF;
+        page[13] = trigger_rec.lux >> 8;
+        page[14] = blocks;
+        status = writeFlashPage(next_addr, page, CAPTURE_HEADER_SIZE);
+    }
+    if (status != DRV_OK) {
+        write_errors++; // il settore resta senza header valido e verrà riusato
+        UART4_WriteString("Cattura: errore di scrittura in flash\r\n");
+        return;
+    }
+
+    snprintf(buffer, sizeof(buffer), "Cattura %lu: trigger %s a %lu ms, %u lux\r\n",
+             (unsigned long)next_seq, trigger_names[trigger_type],
+             (unsigned long)trigger_rec.time, trigger_rec.lux);
+    UART4_WriteString(buffer);
+    last_addr = next_addr;
+    next_seq++;
+    next_addr += FLASH_SECTOR_SIZE;
+    if (next_addr >= CAPTURE_END_ADDR)
+        next_addr = CAPTURE_START_ADDR;
+    captures++;
+}
+
+void capture_start(void) {
+    if (!scanned)
+        scan();
+    samples_attach(&reader, "Cattura");
+    captures = 0;
+    arm();
+    UART4_WriteString("Cattura armata: BTNC per il trigger manuale, un tasto per terminare\r\n");
+    active = 1;
+}
+
+void capture_stop(void) {
+    char buffer[64];
+
+    if (!active)
+        return;
+    capture_poll();
+    if (trigger_type)
+        commit(); // finestra post-trigger incompleta
+    active = 0;
+    snprintf(buffer, sizeof(buffer), "Cattura terminata: %u salvate, %u errori\r\n", captures, write_errors);
+    UART4_WriteString(buffer);
+}
+
+int capture_active(void) {
+    return active;
+}
+
+void capture_trigger(void) {
+    if (active && !trigger_type)
+        pending_button = 1; // il prossimo campione è quello di trigger
+}
+
+static void process(uint32_t seq, const sample_t *s) {
+    if (trigger_type) {
+        if (++post >= CAPTURE_POST) {
+            commit();
+            arm();
+        }
+        return;
+    }
+
+    if (filled < CAPTURE_PRE + 1)
+        filled++;
+    int type = detect(s->lux);
+    if (pending_button)
+        type = CAPTURE_TRIG_BUTTON;
+    if (!type)
+        return;
+
+    trigger_type = type;
+    pre = filled - 1 < CAPTURE_PRE ? filled - 1 : CAPTURE_PRE;
+    post = 1;
+    trigger_seq = seq;
+    trigger_rec.lux = s->lux;
+    trigger_rec.time = s->time;
+}
+
+int capture_poll(void) {
+    const sample_t *s;
+    int consumed = 0;
+
+    while (active && (s = samples_peek(&reader))) {
+        uint32_t seq = reader.next;
+        samples_advance(&reader);
+        process(seq, s);
+        consumed = 1;
+    }
+    return consumed;
+}
+
+void capture_dump_last(void) {
+    static lux_record_t records[CAPTURE_WINDOW];
+    char buffer[80];
+    capture_header_t h;
+
+    if (!scanned)
+        scan();
+    if (last_addr < 0 || !read_header(last_addr, &h)) {
+        UART4_WriteString("Nessuna cattura salvata\r\n");
+        return;
+    }
+    snprintf(buffer, sizeof(buffer), "Cattura %lu: trigger %s a %lu ms, %u pre + %u post\r\n",
+             (unsigned long)h.seq, h.type <= CAPTURE_TRIG_CUSUM ? trigger_names[h.type] : "?",
+             (unsigned long)h.time, h.pre, h.post);
+    UART4_WriteString(buffer);
+    UART4_WriteString("t_ms,lux\r\n");
+
+    for (int b = 0; b < h.blocks; b++) {
+        int n = -1;
+        if (readFlashBlock(last_addr + (b + 1) * FLASH_PAGE_SIZE, page, FLASH_PAGE_SIZE) == DRV_OK)
+            n = codec_block_decode(page, records, CAPTURE_WINDOW);
+        if (n < 0) {
+            UART4_WriteString("Blocco corrotto\r\n");
+            return;
+        }
+        for (int i = 0; i < n; i++) {
+            snprintf(buffer, sizeof(buffer), "%lu,%u\r\n", (unsigned long)records[i].time, records[i].lux);
+            UART4_WriteString(buffer);
+        }
+    }
+}
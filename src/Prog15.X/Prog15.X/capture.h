@@ -0,0 +1,62 @@
+/*
+ * File:   capture.h
+ *
+ * Cattura con trigger, come un oscilloscopio: il ring di samples.h
+ * tiene gli ultimi campioni alla velocità del sensore; al trigger (BTNC,
+ * gradino di lux o CUSUM) la finestra pre e post trigger viene salvata in
+ * flash in un unico settore della regione CAPTURE_START_ADDR..CAPTURE_END_ADDR.
+ */
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+
+// Finestra salvata: CAPTURE_PRE campioni prima del trigger, CAPTURE_POST
+// dal campione di trigger in poi, letta dal ring dei campioni
+#define CAPTURE_PRE         32
+#define CAPTURE_POST        32
+#define CAPTURE_WINDOW      (CAPTURE_PRE + CAPTURE_POST)
+
+// Trigger
+#define CAPTURE_TRIG_BUTTON 1
+#define CAPTURE_TRIG_STEP   2   // |lux - lux precedente| > CAPTURE_STEP_LUX
+#define CAPTURE_TRIG_CUSUM  3   // CUSUM a due lati rispetto alla media mobile
+
+#define CAPTURE_STEP_LUX        200
+#define CAPTURE_CUSUM_DRIFT     10  // scarto tollerato per campione (lux)
+#define CAPTURE_CUSUM_THRESHOLD 150 // somma cumulata che fa scattare il trigger
+#define CAPTURE_MEAN_SHIFT      3   // media mobile esponenziale, peso 1/8
+
+// Header nella prima pagina del settore, seguito dai blocchi del codec
+// nelle pagine successive (little endian):
+//  0     magic
+//  1     tipo di trigger
+//  2     campioni pre trigger
+//  3     campioni post trigger
+//  4-7   numero di sequenza della cattura
+//  8-11  timestamp (ms) del campione di trigger
+//  12-13 lux del campione di trigger
+//  14    blocchi del codec
+#define CAPTURE_MAGIC       0xC7
+#define CAPTURE_HEADER_SIZE 15
+
+// Avvia la cattura: cerca in flash la prossima posizione libera e arma il trigger
+void capture_start(void);
+
+// Termina la cattura e stampa il riepilogo
+void capture_stop(void);
+
+int capture_active(void);
+
+// Valuta i trigger sui campioni nuovi del ring e salva la finestra quando
+// è completa. Ritorna 1 se ha consumato campioni
+int capture_poll(void);
+
+// Trigger manuale (BTNC)
+void capture_trigger(void);
+
+// Stampa su UART l'ultima cattura salvata in CSV
+void capture_dump_last(void);
+
+#endif // CAPTURE_H
@@ -0,0 +1,165 @@
+/* 
+ * File:   clock.c
+ * 
+ * Cambio di SYSCLK/PBCLK a runtime. Per cambiare i parametri del PLL si
+ * passa prima su FRC, poi si riattiva FRCPLL con i nuovi valori.
+ */
+
+#include <p32xxxx.h>
+#include <stdio.h>
+#include "clock.h"
+#include "Timer.h"
+#include "Uart.h"
+#include "i2c.h"
+#include "spi.h"
+#include "Audio_PMW.h"
+#include "drv.h"
+
+// Verifica a tempo di compilazione della configurazione di avvio
+#if CLOCK_PLL_IN_HZ < 4000000 || CLOCK_PLL_IN_HZ > 5000000
+#error "Ingresso del PLL fuori dall'intervallo 4-5 MHz"
+#endif
+#if CLOCK_BOOT_SYSCLK > CLOCK_MAX_SYSCLK
+#error "SYSCLK di avvio oltre il massimo del dispositivo"
+#endif
+#if CLOCK_BOOT_PBCLK / (16 * UART_BAUD) < 2 || CLOCK_BOOT_PBCLK / (16 * UART_BAUD) > 65536
+#error "Baud rate UART non ottenibile con il PBCLK di avvio"
+#endif
+#if TIMER1_PR(CLOCK_BOOT_PBCLK) > 65535 || TIMER2_PR(CLOCK_BOOT_PBCLK) > 65535
+#error "Tick di 1ms fuori dal range dei timer a 16 bit"
+#endif
+#if AUDIO_PR(CLOCK_BOOT_PBCLK) > 65535
+#error "Periodo PWM audio fuori dal range del Timer3"
+#endif
+#if I2C_BRG(CLOCK_BOOT_PBCLK) > 4095 || SPI_FLASH_BRG(CLOCK_BOOT_PBCLK) > 511
+#error "Divisori I2C/SPI fuori range"
+#endif
+
+// Codifiche dei campi di OSCCON
+#define NOSC_FRC        0
+#define NOSC_FRCPLL     1
+#define PLLMULT_20      5
+#define PLLODIV_1       0
+#define PLLODIV_2       1
+
+typedef struct {
+    unsigned int sysclk;
+    unsigned char pll;      // 0 = FRC diretto
+    unsigned char pllodiv;  // codifica OSCCON.PLLODIV
+    unsigned char pbdiv;    // codifica OSCCON.PBDIV (divisore = 1 << pbdiv)
+} clock_mode_t;
+
+static const clock_mode_t modes[CLOCK_NUM_MODES] = {
+    { CLOCK_FRC_HZ, 0, 0, 0 },                      // CLOCK_MODE_LOW
+    { CLOCK_BOOT_SYSCLK, 1, PLLODIV_2, 1 },         // CLOCK_MODE_NORMAL
+    { CLOCK_PLL_IN_HZ * 20, 1, PLLODIV_1, 1 },      // CLOCK_MODE_HIGH
+};
+
+static const char *mode_names[CLOCK_NUM_MODES] = { "basso consumo", "normale", "prestazioni" };
+
+// Driver da notificare: ognuno ricalcola i divisori dal nuovo PBCLK
+static void (* const clock_clients[])(unsigned int pbclk) = {
+    Timer_clock_changed,
+    UART4_clock_changed,
+    i2c_clock_changed,
+    SPI1_clock_changed,
+    audio_clock_changed,
+};
+
+static int current_mode = CLOCK_MODE_NORMAL;
+
+unsigned int clock_sysclk(void) {
+    return modes[current_mode].sysclk;
+}
+
+unsigned int clock_pbclk(void) {
+    return modes[current_mode].sysclk >> modes[current_mode].pbdiv;
+}
+
+int clock_mode(void) {
+    return current_mode;
+}
+
+// Wait state della flash programma: 0 fino a 30 MHz, +1 ogni 30 MHz
+static void set_wait_states(unsigned int sysclk) {
+    CHECONbits.PFMWS = (sysclk - 1) / 30000000;
+}
+
+// Il timeout è in tick del clock di partenza: se il core rallenta durante
+// il cambio l'attesa si allunga, ma resta limitata
+static int switch_oscillator(int nosc) {
+    int status;
+
+    OSCCONbits.NOSC = nosc;
+    OSCCONbits.OSWEN = 1;
+    status = WAIT_WHILE(OSCCONbits.OSWEN, CLOCK_SWITCH_TIMEOUT_US, clock_stats);
+    if (status != DRV_OK) {
+        // il nuovo oscillatore non è pronto: si annulla la richiesta
+        OSCCONbits.NOSC = OSCCONbits.COSC;
+        OSCCONbits.OSWEN = 0;
+    }
+    return status;
+}
+
+static void notify_clients(void) {
+    for (unsigned int i = 0; i < sizeof(clock_clients) / sizeof(clock_clients[0]); i++) {
+        clock_clients[i](clock_pbclk());
+    }
+}
+
+int clock_set_mode(int mode) {
+    const clock_mode_t *m;
+    const clock_mode_t *old = &modes[current_mode];
+    int running = current_mode; // modalità in cui si trova la scheda
+    int status;
+
+    if (mode < 0 || mode >= CLOCK_NUM_MODES)
+        return DRV_INVALID;
+    if (mode == current_mode)
+        return DRV_OK;
+    m = &modes[mode];
+
+    // La UART deve aver finito di trasmettere prima di cambiare baud
+    UART4_WaitIdle();
+
+    __builtin_disable_interrupts();
+    if (m->sysclk > clock_sysclk())
+        set_wait_states(m->sysclk); // più wait state prima di accelerare
+
+    SYSKEY = 0;
+    SYSKEY = 0xAA996655; // sblocco di OSCCON
+    SYSKEY = 0x556699AA;
+    status = switch_oscillator(NOSC_FRC);
+    if (status == DRV_OK && m->pll) {
+        OSCCONbits.PLLMULT = PLLMULT_20;
+        OSCCONbits.PLLODIV = m->pllodiv;
+        status = switch_oscillator(NOSC_FRCPLL);
+        if (status != DRV_OK && old->pll) {
+            // si torna al PLL di partenza, che era agganciato; se non
+            // riparte nemmeno quello la scheda resta su FRC
+            OSCCONbits.PLLODIV = old->pllodiv;
+            if (switch_oscillator(NOSC_FRCPLL) != DRV_OK)
+                running = CLOCK_MODE_LOW;
+        }
+    }
+    if (status != DRV_OK)
+        mode = running;
+    OSCCONbits.PBDIV = modes[mode].pbdiv;
+    SYSKEY = 0x33333333; // blocco
+
+    // Meno wait state solo dopo aver rallentato (o dopo un cambio fallito)
+    set_wait_states(modes[mode].sysclk);
+    if (mode != current_mode) {
+        current_mode = mode;
+        notify_clients();
+    }
+    __builtin_enable_interrupts();
+    return status;
+}
+
+void clock_report(void) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "Clock %s: SYSCLK %u Hz, PBCLK %u Hz\r\n",
+             mode_names[current_mode], clock_sysclk(), clock_pbclk());
+    UART4_WriteString(buffer);
+}
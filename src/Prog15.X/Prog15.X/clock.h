@@ -0,0 +1,42 @@
+/* 
+ * File:   clock.h
+ * 
+ * Gestione del clock: unica fonte per SYSCLK/PBCLK. I driver calcolano
+ * i loro divisori da clock_pbclk() e vengono notificati a ogni cambio.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+// Configurazione di avvio, deve coincidere con i #pragma config di newmain.c
+#define CLOCK_FRC_HZ        8000000 // FNOSC = FRCPLL
+#define CLOCK_PLL_IDIV      2       // FPLLIDIV = DIV_2
+#define CLOCK_PLL_MUL       20      // FPLLMUL = MUL_20
+#define CLOCK_PLL_ODIV      2       // FPLLODIV = DIV_2
+#define CLOCK_PB_DIV        2       // FPBDIV = DIV_2
+
+#define CLOCK_PLL_IN_HZ     (CLOCK_FRC_HZ / CLOCK_PLL_IDIV)
+#define CLOCK_BOOT_SYSCLK   (CLOCK_PLL_IN_HZ * CLOCK_PLL_MUL / CLOCK_PLL_ODIV) // 40 MHz
+#define CLOCK_BOOT_PBCLK    (CLOCK_BOOT_SYSCLK / CLOCK_PB_DIV)                 // 20 MHz
+#define CLOCK_MAX_SYSCLK    100000000
+
+// Modalità selezionabili a runtime
+#define CLOCK_MODE_LOW      0 // FRC senza PLL: SYSCLK 8 MHz, PBCLK 8 MHz
+#define CLOCK_MODE_NORMAL   1 // configurazione di avvio: 40 / 20 MHz
+#define CLOCK_MODE_HIGH     2 // FRCPLL x20 /1: SYSCLK 80 MHz, PBCLK 40 MHz
+#define CLOCK_NUM_MODES     3
+
+unsigned int clock_sysclk(void);
+unsigned int clock_pbclk(void);
+int clock_mode(void);
+
+// Cambia modalità e ricalcola i divisori di tutte le periferiche.
+// Da chiamare dal main loop, senza trasferimenti I2C/SPI in corso.
+// Ritorna DRV_OK, DRV_INVALID o DRV_TIMEOUT se l'oscillatore non è
+// partito: in quel caso la modalità resta quella precedente
+int clock_set_mode(int mode);
+
+// Stampa frequenze e modalità correnti su UART
+void clock_report(void);
+
+#endif // CLOCK_H
@@ -0,0 +1,133 @@
+/* 
+ * File:   codec.c
+ * 
+ * Codec delta/varint per i blocchi di campioni (vedi codec.h)
+ */
+
+#include "codec.h"
+
+static void put16(uint8_t *p, uint16_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = v;
+    p[1] = v >> 8;
+    p[2] = v >> 16;
+    p[3] = v >> 24;
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Interi con segno -> senza segno, i valori piccoli restano piccoli
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+// 7 bit per byte, bit 7 = continua
+static int put_varint(uint8_t *p, uint32_t v) {
+    int n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// Ritorna i byte letti, 0 se il varint supera end o 5 byte
+static int get_varint(const uint8_t *p, const uint8_t *end, uint32_t *v) {
+    uint32_t result = 0;
+    for (int n = 0; n < 5 && p + n < end; n++) {
+        result |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *v = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+void codec_block_init(codec_block_t *b, uint32_t seq) {
+    b->length = CODEC_HEADER_SIZE;
+    b->count = 0;
+    b->buf[0] = CODEC_MAGIC;
+    b->buf[1] = 0;
+    put16(&b->buf[2], 0);
+    put32(&b->buf[4], seq);
+    put16(&b->buf[8], 0);
+    put32(&b->buf[10], 0);
+}
+
+int codec_block_add(codec_block_t *b, uint16_t lux, uint32_t time) {
+    if (b->count == 0) {
+        put16(&b->buf[8], lux);
+        put32(&b->buf[10], time);
+    } else {
+        if (b->count >= CODEC_MAX_SAMPLES || b->length + CODEC_MAX_SAMPLE_BYTES > CODEC_BLOCK_SIZE)
+            return 0;
+        b->length += put_varint(&b->buf[b->length], zigzag((int32_t)lux - (int32_t)b->last_lux));
+        b->length += put_varint(&b->buf[b->length], zigzag((int32_t)(time - b->last_time)));
+    }
+    b->last_lux = lux;
+    b->last_time = time;
+    b->count++;
+    // L'header resta aggiornato: il buffer si può scrivere in ogni momento
+    b->buf[1] = b->count;
+    put16(&b->buf[2], b->length - CODEC_HEADER_SIZE);
+    return 1;
+}
+
+int codec_read_header(const uint8_t *buf, codec_header_t *h) {
+    if (buf[0] != CODEC_MAGIC)
+        return 0;
+    h->count = buf[1];
+    h->length = get16(&buf[2]);
+    h->seq = get32(&buf[4]);
+    h->base_lux = get16(&buf[8]);
+    h->base_time = get32(&buf[10]);
+    return h->count > 0 && h->length <= CODEC_BLOCK_SIZE - CODEC_HEADER_SIZE;
+}
+
+int codec_block_decode(const uint8_t *buf, lux_record_t *out, int max) {
+    codec_header_t h;
+    const uint8_t *p = buf + CODEC_HEADER_SIZE;
+    const uint8_t *end;
+    uint32_t v;
+    int n, i;
+
+    if (!codec_read_header(buf, &h))
+        return -1;
+    end = p + h.length;
+    if (max <= 0)
+        return 0;
+
+    uint16_t lux = h.base_lux;
+    uint32_t time = h.base_time;
+    out[0].lux = lux;
+    out[0].time = time;
+    for (i = 1; i < h.count && i < max; i++) {
+        if (!(n = get_varint(p, end, &v)))
+            return -1;
+        p += n;
+        lux = (uint16_t)(lux + unzigzag(v));
+        if (!(n = get_varint(p, end, &v)))
+            return -1;
+        p += n;
+        time += (uint32_t)unzigzag(v);
+        out[i].lux = lux;
+        out[i].time = time;
+    }
+    return i;
+}
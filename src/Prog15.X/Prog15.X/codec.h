@@ -0,0 +1,63 @@
+/* 
+ * File:   codec.h
+ * 
+ * Codec a blocchi per i campioni di luce: valore base nell'header, poi
+ * delta di lux e timestamp codificati zigzag + varint.
+ * Non dipende dall'hardware, per poterlo usare anche sul PC.
+ */
+
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <stdint.h>
+
+// Un blocco occupa al massimo una pagina della flash
+#define CODEC_BLOCK_SIZE    256
+#define CODEC_HEADER_SIZE   14
+#define CODEC_MAGIC         0xB1
+#define CODEC_MAX_SAMPLES   255
+// Caso peggiore per campione: delta lux 3 byte + delta tempo 5 byte
+#define CODEC_MAX_SAMPLE_BYTES 8
+
+// Layout dell'header (little endian):
+//  0     magic
+//  1     numero di campioni
+//  2-3   byte di payload dopo l'header
+//  4-7   numero di sequenza del blocco
+//  8-9   lux del primo campione
+//  10-13 timestamp (ms) del primo campione
+typedef struct {
+    uint8_t count;
+    uint16_t length;
+    uint32_t seq;
+    uint16_t base_lux;
+    uint32_t base_time;
+} codec_header_t;
+
+typedef struct {
+    uint16_t lux;
+    uint32_t time;
+} lux_record_t;
+
+typedef struct {
+    uint8_t buf[CODEC_BLOCK_SIZE]; // header + payload, sempre decodificabile
+    uint16_t length;               // byte usati, header incluso
+    uint8_t count;
+    uint16_t last_lux;
+    uint32_t last_time;
+} codec_block_t;
+
+// Prepara un blocco vuoto con il numero di sequenza indicato
+void codec_block_init(codec_block_t *b, uint32_t seq);
+
+// Aggiunge un campione, ritorna 0 se il blocco è pieno
+int codec_block_add(codec_block_t *b, uint16_t lux, uint32_t time);
+
+// Legge l'header di un blocco, ritorna 0 se buf non contiene un blocco valido
+int codec_read_header(const uint8_t *buf, codec_header_t *h);
+
+// Decodifica fino a max campioni, ritorna il numero di campioni o -1 se
+// il blocco è corrotto
+int codec_block_decode(const uint8_t *buf, lux_record_t *out, int max);
+
+#endif // CODEC_H
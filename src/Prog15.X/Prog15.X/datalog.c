@@ -0,0 +1,152 @@
+/* 
+ * File:   datalog.c
+ * 
+ * Log circolare dei campioni nella regione LOG_START_ADDR..LOG_END_ADDR.
+ * Ogni pagina contiene un blocco del codec con numero di sequenza
+ * crescente; il settore viene cancellato quando la scrittura vi entra.
+ * All'avvio si cerca il settore con la sequenza più alta leggendo solo
+ * l'header della sua prima pagina, poi la prima pagina libera al suo interno.
+ */
+
+#include <stdio.h>
+#include "datalog.h"
+#include "codec.h"
+#include "samples.h"
+#include "spi.h"
+#include "Uart.h"
+#include "clock.h"
+#include "drv.h"
+
+#define SECTORS_PER_STEP 16 // header letti per ogni passo di boot_poll()
+
+static codec_block_t block;
+static sample_reader_t reader;
+static int write_addr = LOG_START_ADDR; // prossima pagina da scrivere
+static uint32_t next_seq = 0;
+
+// Stato della scansione iniziale
+static int scan_addr = LOG_START_ADDR;
+static int scan_found = 0;
+static int scan_done = 0;
+static int last_sector = LOG_START_ADDR;
+
+// Statistiche per il rapporto di compressione
+static unsigned int logged_samples = 0;
+static unsigned int encoded_bytes = 0;  // blocchi già scritti in flash
+static uint64_t encode_ns = 0;          // tempo speso nel codec
+static unsigned int write_errors = 0;
+
+static int read_header(int addr, codec_header_t *h) {
+    unsigned char buf[CODEC_HEADER_SIZE];
+    if (readFlashBlock(addr, buf, CODEC_HEADER_SIZE) != DRV_OK)
+        return 0;
+    return codec_read_header(buf, h);
+}
+
+int datalog_init_step(void) {
+    codec_header_t h;
+
+    if (scan_done)
+        return 1;
+
+    for (int i = 0; i < SECTORS_PER_STEP && scan_addr < LOG_END_ADDR; i++) {
+        if (read_header(scan_addr, &h) && (!scan_found || h.seq >= next_seq)) {
+            scan_found = 1;
+            next_seq = h.seq + 1;
+            last_sector = scan_addr;
+        }
+        scan_addr += FLASH_SECTOR_SIZE;
+    }
+    if (scan_addr < LOG_END_ADDR)
+        return 0;
+
+    // Prima pagina libera nel settore più recente
+    write_addr = last_sector;
+    if (scan_found) {
+        while (write_addr < last_sector + FLASH_SECTOR_SIZE && read_header(write_addr, &h)) {
+            next_seq = h.seq + 1;
+            write_addr += FLASH_PAGE_SIZE;
+        }
+        if (write_addr >= LOG_END_ADDR)
+            write_addr = LOG_START_ADDR;
+    }
+    codec_block_init(&block, next_seq);
+    samples_attach(&reader, "Log flash");
+    scan_done = 1;
+    return 1;
+}
+
+static void write_block(void) {
+    int status = DRV_OK;
+    if (write_addr % FLASH_SECTOR_SIZE == 0)
+        status = EraseSector(write_addr); // entra in un nuovo settore: elimina i dati più vecchi
+    if (status == DRV_OK)
+        status = writeFlashPage(write_addr, block.buf, block.length);
+    if (status == DRV_OK)
+        encoded_bytes += block.length;
+    else
+        write_errors++; // il blocco va perso, si prosegue con la pagina successiva
+
+    write_addr += FLASH_PAGE_SIZE;
+    if (write_addr >= LOG_END_ADDR)
+        write_addr = LOG_START_ADDR;
+    codec_block_init(&block, ++next_seq);
+}
+
+int datalog_poll(void) {
+    const sample_t *s;
+    int consumed = 0;
+
+    if (!scan_done)
+        return 0;
+
+    while ((s = samples_peek(&reader))) {
+        unsigned int start = core_ticks();
+        int added = codec_block_add(&block, s->lux, s->time);
+        unsigned int ticks = core_ticks() - start;
+        if (!added) {
+            // blocco pieno: cancellazione e scrittura della flash non sono
+            // tempo del codec
+            write_block();
+            start = core_ticks();
+            codec_block_add(&block, s->lux, s->time);
+            ticks += core_ticks() - start;
+        }
+        // core timer a SYSCLK/2
+        encode_ns += (uint64_t)ticks * 2000 / (clock_sysclk() / 1000000);
+        logged_samples++;
+        samples_advance(&reader);
+        consumed = 1;
+    }
+    return consumed;
+}
+
+void datalog_flush(void) {
+    datalog_poll();
+    if (scan_done && block.count)
+        write_block();
+}
+
+void datalog_report(void) {
+    char buffer[64];
+    // Formato grezzo di riferimento: lux 16 bit + timestamp 32 bit
+    unsigned int raw = logged_samples * (sizeof(uint16_t) + sizeof(uint32_t));
+    unsigned int encoded = encoded_bytes + (block.count ? block.length : 0);
+
+    snprintf(buffer, sizeof(buffer), "Campioni registrati: %u\r\n", logged_samples);
+    UART4_WriteString(buffer);
+    snprintf(buffer, sizeof(buffer), "Byte grezzi: %u, compressi: %u\r\n", raw, encoded);
+    UART4_WriteString(buffer);
+    if (encoded) {
+        snprintf(buffer, sizeof(buffer), "Rapporto di compressione: %u.%02u\r\n",
+                 raw / encoded, (raw % encoded) * 100 / encoded);
+        UART4_WriteString(buffer);
+    }
+    if (logged_samples) {
+        snprintf(buffer, sizeof(buffer), "Codifica: %u ns/campione\r\n",
+                 (unsigned int)(encode_ns / logged_samples));
+        UART4_WriteString(buffer);
+    }
+    snprintf(buffer, sizeof(buffer), "Prossima pagina: 0x%06X, errori di scrittura: %u\r\n", write_addr, write_errors);
+    UART4_WriteString(buffer);
+}
@@ -0,0 +1,28 @@
+/* 
+ * File:   datalog.h
+ * 
+ * Log dei campioni in flash, un blocco compresso (codec.h) per pagina.
+ * I campioni arrivano dal ring di samples.h con un cursore proprio
+ */
+
+#ifndef DATALOG_H
+#define DATALOG_H
+
+#include <stdint.h>
+
+// Un passo del recupero della posizione di scrittura, ritorna 1 a fine
+// scansione (da usare come inizializzazione differita in boot.c)
+int datalog_init_step(void);
+
+// Accoda i campioni nuovi del ring, scrive la pagina in flash quando il
+// blocco è pieno. Ritorna 1 se ha consumato campioni
+int datalog_poll(void);
+
+// Accoda i campioni rimasti e scrive il blocco parziale corrente (es. a
+// fine monitoraggio)
+void datalog_flush(void);
+
+// Stampa su UART campioni registrati e rapporto di compressione
+void datalog_report(void);
+
+#endif // DATALOG_H
@@ -0,0 +1,52 @@
+/* 
+ * File:   drv.c
+ * 
+ * Contatori di errore dei driver e latenza del main loop
+ */
+
+#include <stdio.h>
+#include "drv.h"
+#include "Uart.h"
+
+drv_stats_t i2c1_stats;
+drv_stats_t spi1_stats;
+drv_stats_t uart4_stats;
+drv_stats_t lcd_stats;
+drv_stats_t clock_stats;
+
+static unsigned int loop_last = 0;
+static unsigned int loop_max = 0; // in tick del core timer
+
+void delay_us(unsigned int us) {
+    unsigned int start = core_ticks();
+    unsigned int limit = us_to_ticks(us);
+    while (core_ticks() - start < limit) { ; }
+}
+
+void drv_loop_mark(void) {
+    unsigned int now = core_ticks();
+    if (loop_last && now - loop_last > loop_max)
+        loop_max = now - loop_last;
+    loop_last = now;
+}
+
+static void print_stats(const char *name, const drv_stats_t *s) {
+    char buffer[80];
+    snprintf(buffer, sizeof(buffer), "%s: timeout %u, nack %u, errori bus %u, recovery %u\r\n",
+             name, s->timeouts, s->nacks, s->bus_errors, s->recoveries);
+    UART4_WriteString(buffer);
+}
+
+void drv_report(void) {
+    char buffer[48];
+
+    print_stats("I2C1", &i2c1_stats);
+    print_stats("SPI1", &spi1_stats);
+    print_stats("UART4", &uart4_stats);
+    print_stats("LCD", &lcd_stats);
+    print_stats("Clock", &clock_stats);
+    snprintf(buffer, sizeof(buffer), "Latenza max main loop: %u us\r\n",
+             loop_max / (clock_sysclk() / 2000000));
+    UART4_WriteString(buffer);
+    loop_max = 0; // nuova finestra di misura
+}
@@ -0,0 +1,78 @@
+/* 
+ * File:   drv.h
+ * 
+ * Codici di stato, attese con timeout e contatori di errore dei driver.
+ * Ogni attesa su un registro è limitata in cicli del core timer, così
+ * un guasto sul bus non blocca mai il main loop.
+ */
+
+#ifndef DRV_H
+#define DRV_H
+
+#include <p32xxxx.h>
+#include "clock.h"
+
+// Codici di stato (le funzioni che leggono un byte ritornano il byte, >= 0)
+#define DRV_OK          0
+#define DRV_TIMEOUT     -1
+#define DRV_NACK        -2
+#define DRV_BUS_ERROR   -3
+#define DRV_UNSUPPORTED -4  // operazione non disponibile sul dispositivo collegato
+#define DRV_INVALID     -5  // parametro fuori dai limiti
+
+// Timeout dei singoli driver
+#define I2C_TIMEOUT_US      1000    // un byte a 100 kHz dura 90 us
+#define SPI_TIMEOUT_US      1000    // un byte a 625 kHz dura 13 us
+#define UART_TIMEOUT_US     5000    // un byte a 9600 baud dura 1 ms
+#define UART_RX_TIMEOUT_US  10000000
+#define LCD_TIMEOUT_US      5000    // il comando più lento (clear) dura 1.6 ms
+#define CLOCK_SWITCH_TIMEOUT_US 5000 // aggancio del PLL: al massimo 2 ms
+
+typedef struct {
+    unsigned int timeouts;
+    unsigned int nacks;
+    unsigned int bus_errors;
+    unsigned int recoveries;
+} drv_stats_t;
+
+extern drv_stats_t i2c1_stats;
+extern drv_stats_t spi1_stats;
+extern drv_stats_t uart4_stats;
+extern drv_stats_t lcd_stats;
+extern drv_stats_t clock_stats;
+
+// Contatore del core timer (SYSCLK/2)
+static inline unsigned int core_ticks(void) {
+    return __builtin_mfc0(9, 0);
+}
+
+static inline unsigned int us_to_ticks(unsigned int us) {
+    return us * (clock_sysclk() / 2000000);
+}
+
+// Attende finché cond è vera, al massimo us microsecondi.
+// Vale DRV_OK o DRV_TIMEOUT (che viene anche contato in stats)
+#define WAIT_WHILE(cond, us, stats) ({                              \
+    unsigned int _start = core_ticks();                             \
+    unsigned int _limit = us_to_ticks(us);                          \
+    int _status = DRV_OK;                                           \
+    while (cond) {                                                  \
+        if (core_ticks() - _start > _limit) {                       \
+            (stats).timeouts++;                                     \
+            _status = DRV_TIMEOUT;                                  \
+            break;                                                  \
+        }                                                           \
+    }                                                               \
+    _status;                                                        \
+})
+
+// Attesa attiva breve (es. temporizzazione del bus recovery)
+void delay_us(unsigned int us);
+
+// Misura della latenza del main loop: da chiamare a ogni iterazione
+void drv_loop_mark(void);
+
+// Stampa contatori di errore e latenza massima del main loop
+void drv_report(void);
+
+#endif // DRV_H
@@ -0,0 +1,54 @@
+/* 
+ * File:   events.c
+ * 
+ * Coda eventi lock-free ISR -> main loop.
+ * Le ISR che producono eventi girano tutte a IPL1 e quindi non si
+ * interrompono a vicenda: dal punto di vista della coda sono un unico
+ * produttore. head e' scritto solo dal produttore, tail solo dal
+ * consumatore, per cui non serve disabilitare gli interrupt.
+ */
+
+#include "events.h"
+#include "Timer.h"
+
+#if (EVENT_QUEUE_SIZE & (EVENT_QUEUE_SIZE - 1)) != 0
+#error "EVENT_QUEUE_SIZE deve essere una potenza di 2"
+#endif
+
+#define barrier() __asm__ __volatile__("" ::: "memory")
+
+static event_t queue[EVENT_QUEUE_SIZE];
+static volatile unsigned int head = 0; // prossima posizione da scrivere
+static volatile unsigned int tail = 0; // prossima posizione da leggere
+static volatile unsigned int dropped = 0;
+
+int event_push(uint8_t type, uint8_t data) {
+    unsigned int h = head;
+
+    if (h - tail >= EVENT_QUEUE_SIZE) {
+        dropped++;
+        return 0;
+    }
+    event_t *ev = &queue[h & (EVENT_QUEUE_SIZE - 1)];
+    ev->type = type;
+    ev->data = data;
+    ev->timestamp = millis();
+    barrier(); // l'evento deve essere completo prima di pubblicarlo
+    head = h + 1;
+    return 1;
+}
+
+int event_pop(event_t *ev) {
+    unsigned int t = tail;
+
+    if (t == head)
+        return 0;
+    *ev = queue[t & (EVENT_QUEUE_SIZE - 1)];
+    barrier(); // copia completata prima di liberare lo slot
+    tail = t + 1;
+    return 1;
+}
+
+unsigned int event_dropped(void) {
+    return dropped;
+}
@@ -0,0 +1,37 @@
+/* 
+ * File:   events.h
+ * 
+ * Coda eventi lock-free ISR -> main loop (singolo produttore, singolo consumatore)
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdint.h>
+
+// Dimensione della coda, deve essere una potenza di 2
+#define EVENT_QUEUE_SIZE 32
+
+// Tipi di evento
+#define EV_BUTTON   1   // BTNC premuto (gia' filtrato dal debounce)
+#define EV_UART_RX  2   // Carattere ricevuto su UART4 (in data)
+#define EV_TIMER    3   // Scadenza periodica del Timer1
+
+typedef struct {
+    uint8_t type;
+    uint8_t data;
+    uint32_t timestamp; // ms dall'avvio (millis())
+} event_t;
+
+// Inserisce un evento, da chiamare solo dalle ISR (tutte a priorita' 1).
+// Ritorna 0 se la coda e' piena (l'evento viene contato come perso)
+int event_push(uint8_t type, uint8_t data);
+
+// Estrae il prossimo evento, da chiamare solo dal main loop.
+// Ritorna 0 se la coda e' vuota
+int event_pop(event_t *ev);
+
+// Numero di eventi persi per coda piena
+unsigned int event_dropped(void);
+
+#endif // EVENTS_H
@@ -0,0 +1,173 @@
+/*
+ * File:   flashcache.c
+ *
+ * Cache LRU delle pagine della flash. Le pagine sono poche, la ricerca è
+ * lineare; l'età è il valore di un contatore delle letture all'ultimo uso.
+ * La lettura anticipata scorre con la scansione: quando una pagina
+ * caricata in anticipo viene letta per la prima volta si carica quella
+ * FLASHCACHE_READ_AHEAD pagine più avanti.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "flashcache.h"
+#include "spi.h"
+#include "Uart.h"
+#include "drv.h"
+
+typedef struct {
+    int addr;               // inizio della pagina
+    uint32_t used;          // valore di tick all'ultimo uso
+    uint8_t valid;
+    uint8_t prefetched;     // caricata in anticipo, non ancora letta
+    uint8_t data[FLASH_PAGE_SIZE];
+} cache_page_t;
+
+static cache_page_t pages[FLASHCACHE_PAGES];
+static uint32_t tick = 0;
+static int last_miss = -1;  // pagina dell'ultimo miss, per le scansioni
+
+// Numeri di pagina + 1 delle ultime letture brevi dirette (0: vuoto)
+static int ghosts[FLASHCACHE_GHOSTS];
+static int ghost_next = 0;
+
+static unsigned int hits = 0;
+static unsigned int misses = 0;
+static unsigned int bypassed = 0;
+static unsigned int read_ahead = 0;
+static unsigned int read_ahead_used = 0;
+static unsigned int invalidations = 0;
+
+static int lookup(int page_addr) {
+    for (int i = 0; i < FLASHCACHE_PAGES; i++) {
+        if (pages[i].valid && pages[i].addr == page_addr)
+            return i;
+    }
+    return -1;
+}
+
+// Una pagina vuota o quella usata meno di recente
+static int victim(void) {
+    int oldest = 0;
+
+    for (int i = 0; i < FLASHCACHE_PAGES; i++) {
+        if (!pages[i].valid)
+            return i;
+        if ((int32_t)(pages[i].used - pages[oldest].used) < 0)
+            oldest = i;
+    }
+    return oldest;
+}
+
+// Carica una pagina, ritorna l'indice o un codice di errore
+static int fill(int page_addr, flashcache_read_t read) {
+    int i = victim();
+
+    pages[i].valid = 0;
+    int status = read(page_addr, pages[i].data, FLASH_PAGE_SIZE);
+    if (status != DRV_OK)
+        return status;
+    pages[i].addr = page_addr;
+    pages[i].used = ++tick;
+    pages[i].valid = 1;
+    pages[i].prefetched = 0;
+    return i;
+}
+
+// Lettura anticipata: gli errori vengono ignorati, la pagina sarà letta
+// di nuovo quando serve davvero
+static void prefetch(int page_addr, flashcache_read_t read) {
+    if (flash_geo.size && (uint32_t)page_addr >= flash_geo.size)
+        return;
+    if (lookup(page_addr) >= 0)
+        return;
+    int i = fill(page_addr, read);
+    if (i >= 0) {
+        pages[i].prefetched = 1;
+        read_ahead++;
+    }
+}
+
+static int ghost_check(int page_addr) {
+    int tag = page_addr / FLASH_PAGE_SIZE + 1;
+
+    for (int i = 0; i < FLASHCACHE_GHOSTS; i++) {
+        if (ghosts[i] == tag)
+            return 1;
+    }
+    ghosts[ghost_next] = tag;
+    ghost_next = (ghost_next + 1) % FLASHCACHE_GHOSTS;
+    return 0;
+}
+
+int flashcache_read(int addr, uint8_t *buf, int len, flashcache_read_t read) {
+    while (len > 0) {
+        int page_addr = addr & ~(FLASH_PAGE_SIZE - 1);
+        int offset = addr - page_addr;
+        int chunk = FLASH_PAGE_SIZE - offset;
+        if (chunk > len)
+            chunk = len;
+
+        int i = lookup(page_addr);
+        if (i >= 0) {
+            hits++;
+            pages[i].used = ++tick;
+            if (pages[i].prefetched) {
+                pages[i].prefetched = 0;
+                read_ahead_used++;
+                prefetch(page_addr + FLASHCACHE_READ_AHEAD * FLASH_PAGE_SIZE, read);
+            }
+        } else {
+            misses++;
+            if (chunk < FLASHCACHE_SHORT_READ && !ghost_check(page_addr)) {
+                // Prima lettura breve della pagina: direttamente dalla flash
+                bypassed++;
+                int status = read(addr, buf, chunk);
+                if (status != DRV_OK)
+                    return status;
+            } else {
+                i = fill(page_addr, read);
+                if (i < 0)
+                    return i;
+                if (page_addr == last_miss + FLASH_PAGE_SIZE) {
+                    for (int k = 1; k <= FLASHCACHE_READ_AHEAD; k++)
+                        prefetch(page_addr + k * FLASH_PAGE_SIZE, read);
+                }
+                last_miss = page_addr;
+            }
+        }
+        if (i >= 0)
+            memcpy(buf, &pages[i].data[offset], chunk);
+        addr += chunk;
+        buf += chunk;
+        len -= chunk;
+    }
+    return DRV_OK;
+}
+
+void flashcache_invalidate(int addr, int len) {
+    for (int i = 0; i < FLASHCACHE_PAGES; i++) {
+        if (pages[i].valid && pages[i].addr < addr + len && pages[i].addr + FLASH_PAGE_SIZE > addr) {
+            pages[i].valid = 0;
+            invalidations++;
+        }
+    }
+}
+
+void flashcache_invalidate_all(void) {
+    for (int i = 0; i < FLASHCACHE_PAGES; i++)
+        pages[i].valid = 0;
+    invalidations++;
+}
+
+void flashcache_report(void) {
+    char buffer[96];
+    unsigned int total = hits + misses;
+
+    snprintf(buffer, sizeof(buffer), "Cache flash: %u hit, %u miss (%u%% hit), %u letture brevi dirette\r\n",
+             hits, misses, total ? hits * 100 / total : 0, bypassed);
+    UART4_WriteString(buffer);
+    snprintf(buffer, sizeof(buffer), "Cache flash: %u pagine anticipate (%u usate), %u invalidate\r\n",
+             read_ahead, read_ahead_used, invalidations);
+    UART4_WriteString(buffer);
+}
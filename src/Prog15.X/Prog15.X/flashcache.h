@@ -0,0 +1,37 @@
+/*
+ * File:   flashcache.h
+ *
+ * Cache in RAM delle pagine della flash SPI davanti alle letture di spi.c
+ * (readFlashBlock, readFlashMem). Sostituzione LRU; una lettura che
+ * continua dalla pagina mancata subito prima carica anche le pagine
+ * successive (scansioni sequenziali, es. il dump di una cattura).
+ * Le letture brevi di una pagina mai vista (gli header letti una volta
+ * sola nelle scansioni all'avvio) passano direttamente alla flash senza
+ * caricare la pagina intera: la pagina entra in cache dalla seconda
+ * lettura. Programmazione e cancellazione invalidano le pagine toccate.
+ */
+
+#ifndef FLASHCACHE_H
+#define FLASHCACHE_H
+
+#include <stdint.h>
+
+#define FLASHCACHE_PAGES        8   // 2KB di RAM con pagine da 256 byte
+#define FLASHCACHE_READ_AHEAD   2   // pagine caricate oltre quella mancata
+#define FLASHCACHE_SHORT_READ   32  // letture brevi: niente carico al primo accesso
+#define FLASHCACHE_GHOSTS       4   // pagine lette brevemente di recente
+
+// Lettura diretta dalla flash (spi.c)
+typedef int (*flashcache_read_t)(int addr, uint8_t *buf, int len);
+
+// Legge len byte da addr attraverso la cache
+int flashcache_read(int addr, uint8_t *buf, int len, flashcache_read_t read);
+
+// Da chiamare prima di programmare o cancellare [addr, addr + len)
+void flashcache_invalidate(int addr, int len);
+void flashcache_invalidate_all(void);
+
+// Stampa su UART hit, miss e letture anticipate
+void flashcache_report(void);
+
+#endif // FLASHCACHE_H
@@ -0,0 +1,131 @@
+/*
+ * File:   flicker.c
+ *
+ * Finestre acquisite a interrupt (ADC.c, Timer5) e analizzate nel main
+ * loop. Il tempo del banco di filtri viene misurato con il core timer e
+ * riportato alla fine, per confrontarlo con il benchmark su host
+ * (src/replay, make bench).
+ */
+
+#include <stdio.h>
+#include "flicker.h"
+#include "goertzel.h"
+#include "ADC.h"
+#include "Uart.h"
+#include "Timer.h"
+#include "drv.h"
+
+#define FLICKER_MIN_DC  8   // media sotto cui il segnale è troppo basso
+
+static volatile int16_t samples[FLICKER_N];
+static int16_t coeffs[FLICKER_BINS];
+
+static int active = 0;
+static int acquiring = 0;
+static unsigned int window_time;
+
+static unsigned int windows = 0;
+static unsigned int kernel_us = 0;      // somma su tutte le finestre
+static unsigned int kernel_us_max = 0;
+
+static void start_window(void) {
+    window_time = millis();
+    adc_fast_start(samples, FLICKER_N, FLICKER_HZ);
+    acquiring = 1;
+}
+
+void flicker_start(void) {
+    char buffer[80];
+
+    for (int b = 0; b < FLICKER_BINS; b++)
+        coeffs[b] = goertzel_coeff(FLICKER_MIN_HZ + b * FLICKER_BIN_HZ, FLICKER_HZ);
+    snprintf(buffer, sizeof(buffer), "Flicker su AN2: %u Hz, %u-%u Hz a passi di %u Hz, un tasto per terminare\r\n",
+             FLICKER_HZ, FLICKER_MIN_HZ, FLICKER_MAX_HZ, FLICKER_BIN_HZ);
+    UART4_WriteString(buffer);
+    active = 1;
+    windows = 0;
+    kernel_us = 0;
+    kernel_us_max = 0;
+    start_window();
+}
+
+void flicker_stop(void) {
+    char buffer[128];
+
+    adc_fast_stop();
+    active = 0;
+    acquiring = 0;
+    if (!windows)
+        return;
+    unsigned int avg = kernel_us / windows;
+    snprintf(buffer, sizeof(buffer), "Goertzel: %u filtri x %u campioni, %u us per finestra (max %u), %u ns per campione e filtro\r\n",
+             FLICKER_BINS, FLICKER_N, avg, kernel_us_max, avg * 1000 / (FLICKER_BINS * FLICKER_N));
+    UART4_WriteString(buffer);
+}
+
+int flicker_active(void) {
+    return active;
+}
+
+static void analyze(void) {
+    int16_t *x = (int16_t *)samples; // acquisizione finita, l'ISR non scrive più
+    char buffer[96];
+    int32_t sum = 0;
+    int min = x[0], max = x[0];
+
+    for (int i = 0; i < FLICKER_N; i++) {
+        sum += x[i];
+        if (x[i] < min)
+            min = x[i];
+        if (x[i] > max)
+            max = x[i];
+    }
+    int dc = sum / FLICKER_N;
+    for (int i = 0; i < FLICKER_N; i++)
+        x[i] -= dc;
+
+    // Bin con la potenza massima
+    unsigned int start = core_ticks();
+    int best = 0;
+    int64_t best_power = -1;
+    for (int b = 0; b < FLICKER_BINS; b++) {
+        int64_t power = goertzel_power(coeffs[b], x, FLICKER_N);
+        if (power > best_power) {
+            best_power = power;
+            best = b;
+        }
+    }
+    unsigned int us = (core_ticks() - start) / (clock_sysclk() / 2000000);
+    kernel_us += us;
+    if (us > kernel_us_max)
+        kernel_us_max = us;
+    windows++;
+
+    if (dc < FLICKER_MIN_DC) {
+        UART4_WriteString("Flicker: segnale troppo basso\r\n");
+        return;
+    }
+    unsigned int percent = (max - min) * 100 / (max + min);
+    unsigned int depth = goertzel_amplitude(best_power, FLICKER_N) * 100 / dc;
+    if (depth < FLICKER_MIN_DEPTH)
+        snprintf(buffer, sizeof(buffer), "Flicker %u%%, nessuna frequenza dominante, media %d\r\n", percent, dc);
+    else
+        snprintf(buffer, sizeof(buffer), "Flicker %u%%, dominante %u Hz (modulazione %u%%), media %d\r\n",
+                 percent, FLICKER_MIN_HZ + best * FLICKER_BIN_HZ, depth, dc);
+    UART4_WriteString(buffer);
+}
+
+int flicker_poll(void) {
+    if (!active)
+        return 0;
+    if (acquiring && adc_fast_done()) {
+        acquiring = 0;
+        analyze();
+        return 1;
+    }
+    if (!acquiring && millis() - window_time >= FLICKER_PERIOD_MS) {
+        start_window();
+        return 1;
+    }
+    return 0;
+}
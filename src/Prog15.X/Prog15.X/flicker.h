@@ -0,0 +1,34 @@
+/*
+ * File:   flicker.h
+ *
+ * Analisi del flicker della luce artificiale sull'ingresso analogico AN2.
+ * Il TSL2561 integra per 13.7-402 ms e non vede le oscillazioni a 100/120
+ * Hz: qui AN2 viene campionato a FLICKER_HZ per finestre di FLICKER_N
+ * campioni e un banco di filtri di Goertzel (goertzel.h) misura lo
+ * spettro da FLICKER_MIN_HZ a FLICKER_MAX_HZ. Per ogni finestra vengono
+ * stampati il flicker percentuale (picco-picco), la frequenza dominante e
+ * la sua profondità di modulazione.
+ */
+
+#ifndef FLICKER_H
+#define FLICKER_H
+
+#define FLICKER_HZ          4000
+#define FLICKER_N           400     // 100 ms: bin da 10 Hz, 100 e 120 Hz esatti
+#define FLICKER_MIN_HZ      40
+#define FLICKER_MAX_HZ      1000
+#define FLICKER_BIN_HZ      (FLICKER_HZ / FLICKER_N)
+#define FLICKER_BINS        ((FLICKER_MAX_HZ - FLICKER_MIN_HZ) / FLICKER_BIN_HZ + 1)
+#define FLICKER_PERIOD_MS   1000    // una finestra al secondo
+#define FLICKER_MIN_DEPTH   2       // % di modulazione sotto cui non c'è flicker
+
+// Avvia l'analisi continua, termina con flicker_stop() (un tasto)
+void flicker_start(void);
+void flicker_stop(void);
+int flicker_active(void);
+
+// Da chiamare nel main loop: avvia le finestre e le analizza quando sono
+// complete. Ritorna 1 se ha lavorato
+int flicker_poll(void);
+
+#endif // FLICKER_H
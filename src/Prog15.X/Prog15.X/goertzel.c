@@ -0,0 +1,34 @@
+/*
+ * File:   goertzel.c
+ *
+ * s[n] = x[n] + 2cos(w) s[n-1] - s[n-2], poi
+ * |X|^2 = s1^2 + s2^2 - 2cos(w) s1 s2.
+ * Il prodotto coefficiente x stato è a 64 bit (una MULT sul PIC32), lo
+ * stato a 32 bit: con un bin esatto cresce al massimo di n * |x| / 2.
+ */
+
+#include <math.h>
+#include "goertzel.h"
+
+int16_t goertzel_coeff(unsigned int hz, unsigned int fs) {
+    float c = 2.0f * cosf(2.0f * 3.14159265f * hz / fs);
+    return (int16_t)lrintf(c * (1 << GOERTZEL_Q));
+}
+
+int64_t goertzel_power(int16_t coeff, const int16_t *x, int n) {
+    int32_t s1 = 0, s2 = 0;
+
+    for (int i = 0; i < n; i++) {
+        int32_t s0 = x[i] + (int32_t)(((int64_t)coeff * s1) >> GOERTZEL_Q) - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    int64_t cross = ((int64_t)coeff * s1 >> GOERTZEL_Q) * s2;
+    return (int64_t)s1 * s1 + (int64_t)s2 * s2 - cross;
+}
+
+unsigned int goertzel_amplitude(int64_t power, int n) {
+    if (power <= 0 || n <= 0)
+        return 0;
+    return (unsigned int)(2.0f * sqrtf((float)power) / n + 0.5f);
+}
@@ -0,0 +1,27 @@
+/*
+ * File:   goertzel.h
+ *
+ * Filtro di Goertzel in virgola fissa: potenza di un solo bin della DFT
+ * con una moltiplicazione per campione, senza tabelle di seni né FFT.
+ * Nessuna dipendenza dall'hardware, compila anche su host (benchmark in
+ * src/replay).
+ */
+
+#ifndef GOERTZEL_H
+#define GOERTZEL_H
+
+#include <stdint.h>
+
+#define GOERTZEL_Q  14  // coefficiente 2cos(w) in Q14, |2cos(w)| < 2
+
+// Coefficiente per la frequenza hz con campionamento a fs
+int16_t goertzel_coeff(unsigned int hz, unsigned int fs);
+
+// |X|^2 del bin sulla finestra x di n campioni senza componente continua
+// (|x| < 2^11, n <= 1024: lo stato resta entro 32 bit)
+int64_t goertzel_power(int16_t coeff, const int16_t *x, int n);
+
+// Ampiezza della sinusoide corrispondente: 2 * sqrt(power) / n
+unsigned int goertzel_amplitude(int64_t power, int n);
+
+#endif // GOERTZEL_H
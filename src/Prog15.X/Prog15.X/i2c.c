@@ -1,96 +1,198 @@
-/*
- * Title: i2c lib CT
- * author: CTa
- * date: 01.12.2022
- *  
- */
-
-#include <p32xxxx.h>
-#include "i2c.h"
-#include "Timer.h"
-#include <stdio.h>
-
-unsigned char out_x[2];  // definizione della variabile
-unsigned char out_y[2];  // definizione della variabile
-unsigned char out_z[2];  // definizione della variabile
-int id;
-
-// I2C Master utilities, 100 kHz, using polling rather than interrupts
-// The functions must be callled in the correct order as per the I2C protocol
-// BasysMX3 Accelerometer --> SCL1 = RG2, SDA1 = RG3
-
-
-void i2c_master_setup(void) 
-{
-    TRISGbits.TRISG2 = 1; // SCL
-    TRISGbits.TRISG3 = 1; // SDA
-    
-    I2C1CON = 0x0000; // use default settings for I2C
-    I2C1BRG = 186; // I2CBRG = [1/(2*Fsck) - PGD]*Pblck - 2
-    // Fsck is the freq (100 kHz here), PGD = 104 ns
-    I2C1CONbits.ON = 1; // turn on the I2C1 module
-}
-
-// Start a transmission on the I2C bus
-void i2c_master_start(void) 
-{
-    I2C1CONbits.SEN = 1; // send the start bit
-    while(I2C1CONbits.SEN) { ; } // wait for the start bit to be sent
-}
-
-void i2c_master_restart(void) 
-{
-    I2C1CONbits.RSEN = 1; // send a restart
-    while(I2C1CONbits.RSEN) { ; } // wait for the restart to clear
-}
-
-void i2c_master_send(unsigned char byte) 
-{ // send a byte to slave
-    I2C1TRN = byte; // if an address, bit 0 = 0 for write, 1 for read
-    while(I2C1STATbits.TRSTAT) { ; } // wait for the transmission to finish
-
-    if(I2C1STATbits.ACKSTAT) { // if this is high, slave has not acknowledged
-    //put_U4_String("I2C2 Master: failed to receive ACK\r\n");
-    }
-}
-
-
-unsigned char i2c_master_recv(int ack) 
-{ 
-    I2C1CONbits.RCEN = 1;              // Abilita la ricezione
-    while (!I2C1STATbits.RBF) { ;}    // Attendi che i dati siano ricevuti
-    unsigned char data = I2C1RCV;      // Leggi i dati
-    i2c_master_ack(ack);               // Invia ACK o NACK
-    return data;
-}
-
-
-void i2c_master_ack(int val) 
-{ // sends ACK = 0 (slave should send another byte)
-    // or NACK = 1 (no more bytes requested from slave)
-    I2C1CONbits.ACKDT = val; // store ACK/NACK in ACKDT
-    I2C1CONbits.ACKEN = 1; // send ACKDT
-    while(I2C1CONbits.ACKEN) { ; } // wait for ACK/NACK to be sent
-}
-
-void i2c_master_stop(void) 
-{ // send a STOP:
-    I2C1CONbits.PEN = 1; // comm is complete and master relinquishes bus
-    while(I2C1CONbits.PEN) { ; } // wait for STOP to complete
-}
-
-void i2c_debug_send(uint8_t byte) {
-    char buffer[32];
-    snprintf(buffer, sizeof(buffer), "I2C Send: 0x%02X\r\n", byte);
-    UART4_WriteString(buffer);
-}
-
-uint8_t i2c_debug_recv(void) {
-    uint8_t data = i2c_master_recv(1); // Ricevi un byte
-    char buffer[32];
-    snprintf(buffer, sizeof(buffer), "I2C Recv: 0x%02X\r\n", data);
-    UART4_WriteString(buffer);
-    return data;
-}
-
-
+/*
+ * Title: i2c lib CT
+ * author: CTa
+ * date: 01.12.2022
+ *  
+ */
+
+#include <p32xxxx.h>
+#include "i2c.h"
+#include "Timer.h"
+#include "clock.h"
+#include "drv.h"
+#include "Uart.h"
+#include <stdio.h>
+
+// I2C Master utilities, 100 kHz, using polling rather than interrupts
+// The functions must be callled in the correct order as per the I2C protocol
+// BasysMX3 Accelerometer --> SCL1 = RG2, SDA1 = RG3
+
+
+void i2c_master_setup(void) 
+{
+    TRISGbits.TRISG2 = 1; // SCL
+    TRISGbits.TRISG3 = 1; // SDA
+    
+    I2C1CON = 0x0000; // use default settings for I2C
+    I2C1BRG = I2C_BRG(clock_pbclk()); // I2CBRG = [1/(2*Fsck) - PGD]*Pblck - 2
+    // Fsck is the freq (100 kHz here), PGD = 104 ns
+    I2C1CONbits.ON = 1; // turn on the I2C1 module
+}
+
+// Recompute the baud rate generator after a clock change (bus must be idle)
+void i2c_clock_changed(unsigned int pbclk)
+{
+    I2C1CONbits.ON = 0;
+    I2C1BRG = I2C_BRG(pbclk);
+    I2C1CONbits.ON = 1;
+}
+
+// Every wait is bounded by I2C_TIMEOUT_US, functions return DRV_OK or a
+// negative DRV_ status (i2c_master_recv returns the byte when >= 0)
+
+// Start a transmission on the I2C bus
+int i2c_master_start(void) 
+{
+    I2C1CONbits.SEN = 1; // send the start bit
+    return WAIT_WHILE(I2C1CONbits.SEN, I2C_TIMEOUT_US, i2c1_stats); // wait for the start bit to be sent
+}
+
+int i2c_master_restart(void) 
+{
+    I2C1CONbits.RSEN = 1; // send a restart
+    return WAIT_WHILE(I2C1CONbits.RSEN, I2C_TIMEOUT_US, i2c1_stats); // wait for the restart to clear
+}
+
+int i2c_master_send(unsigned char byte) 
+{ // send a byte to slave
+    I2C1TRN = byte; // if an address, bit 0 = 0 for write, 1 for read¨
+    if (I2C1STATbits.BCL) { // bus collision: TRN write was ignored
+        I2C1STATbits.BCL = 0;
+        i2c1_stats.bus_errors++;
+        return DRV_BUS_ERROR;
+    }
+    if (WAIT_WHILE(I2C1STATbits.TRSTAT, I2C_TIMEOUT_US, i2c1_stats) != DRV_OK) // wait for the transmission to finish
+        return DRV_TIMEOUT;
+
+    if(I2C1STATbits.ACKSTAT) { // if this is high, slave has not acknowledged
+        i2c1_stats.nacks++;
+        return DRV_NACK;
+    }
+    return DRV_OK;
+}
+
+
+int i2c_master_recv(int ack) 
+{ 
+    I2C1CONbits.RCEN = 1;              // Abilita la ricezione
+    if (WAIT_WHILE(!I2C1STATbits.RBF, I2C_TIMEOUT_US, i2c1_stats) != DRV_OK) // Attendi che i dati siano ricevuti
+        return DRV_TIMEOUT;
+    unsigned char data = I2C1RCV;      // Leggi i dati
+    if (i2c_master_ack(ack) != DRV_OK) // Invia ACK o NACK
+        return DRV_TIMEOUT;
+    return data;
+}
+
+
+int i2c_master_ack(int val) 
+{ // sends ACK = 0 (slave should send another byte)
+    // or NACK = 1 (no more bytes requested from slave)
+    I2C1CONbits.ACKDT = val; // store ACK/NACK in ACKDT
+    I2C1CONbits.ACKEN = 1; // send ACKDT
+    return WAIT_WHILE(I2C1CONbits.ACKEN, I2C_TIMEOUT_US, i2c1_stats); // wait for ACK/NACK to be sent
+}
+
+int i2c_master_stop(void) 
+{ // send a STOP:
+    I2C1CONbits.PEN = 1; // comm is complete and master relinquishes bus
+    return WAIT_WHILE(I2C1CONbits.PEN, I2C_TIMEOUT_US, i2c1_stats); // wait for STOP to complete
+}
+
+// Bus clear: a slave holding SDA low is released by clocking SCL up to 9
+// times by hand (open drain emulated with TRIS), then a STOP is generated
+// and the I2C module is restarted
+void i2c_bus_recover(void)
+{
+    I2C1CONbits.ON = 0; // release the pins to the port
+    LATGbits.LATG2 = 0;
+    LATGbits.LATG3 = 0;
+    TRISGbits.TRISG3 = 1; // SDA released
+
+    for (int i = 0; i < 9 && !PORTGbits.RG3; i++) {
+        TRISGbits.TRISG2 = 0; // SCL low
+        delay_us(5);
+        TRISGbits.TRISG2 = 1; // SCL released (high)
+        delay_us(5);
+    }
+
+    // STOP: SDA goes high while SCL is high
+    TRISGbits.TRISG3 = 0; // SDA low
+    delay_us(5);
+    TRISGbits.TRISG2 = 1; // SCL high
+    delay_us(5);
+    TRISGbits.TRISG3 = 1; // SDA high
+    delay_us(5);
+
+    I2C1STATbits.BCL = 0;
+    I2C1CONbits.ON = 1;
+    i2c1_stats.recoveries++;
+}
+
+// Ends a failed transaction: STOP if possible, bus clear if the bus is stuck
+static int i2c_abort(int status)
+{
+    if (status == DRV_TIMEOUT || status == DRV_BUS_ERROR || i2c_master_stop() != DRV_OK)
+        i2c_bus_recover();
+    return status;
+}
+
+// Writes len bytes after the command/register byte cmd
+int i2c_write(unsigned char addr, unsigned char cmd, const unsigned char *data, int len)
+{
+    int status;
+
+    if ((status = i2c_master_start()) != DRV_OK)
+        return i2c_abort(status);
+    if ((status = i2c_master_send(addr << 1)) != DRV_OK)
+        return i2c_abort(status);
+    if ((status = i2c_master_send(cmd)) != DRV_OK)
+        return i2c_abort(status);
+    while (len--) {
+        if ((status = i2c_master_send(*data++)) != DRV_OK)
+            return i2c_abort(status);
+    }
+    if ((status = i2c_master_stop()) != DRV_OK)
+        return i2c_abort(status);
+    return DRV_OK;
+}
+
+// Writes the command/register byte cmd, then reads len bytes with a restart
+int i2c_read(unsigned char addr, unsigned char cmd, unsigned char *buf, int len)
+{
+    int status;
+
+    if ((status = i2c_master_start()) != DRV_OK)
+        return i2c_abort(status);
+    if ((status = i2c_master_send(addr << 1)) != DRV_OK)
+        return i2c_abort(status);
+    if ((status = i2c_master_send(cmd)) != DRV_OK)
+        return i2c_abort(status);
+    if ((status = i2c_master_restart()) != DRV_OK)
+        return i2c_abort(status);
+    if ((status = i2c_master_send((addr << 1) | 1)) != DRV_OK)
+        return i2c_abort(status);
+    for (int i = 0; i < len; i++) {
+        if ((status = i2c_master_recv(i == len - 1)) < 0) // NACK on the last byte
+            return i2c_abort(status);
+        buf[i] = status;
+    }
+    if ((status = i2c_master_stop()) != DRV_OK)
+        return i2c_abort(status);
+    return DRV_OK;
+}
+
+void i2c_debug_send(uint8_t byte) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "I2C Send: 0x%02X\r\n", byte);
+    UART4_WriteString(buffer);
+}
+
+uint8_t i2c_debug_recv(void) {
+    uint8_t data = (uint8_t)i2c_master_recv(1); // Ricevi un byte
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "I2C Recv: 0x%02X\r\n", data);
+    UART4_WriteString(buffer);
+    return data;
+}
+
+
@@ -1,32 +1,45 @@
-/*
- * Title: i2c lib CT header file
- * author: CTa
- * date: 01.12.2022
- *  
- */
-
-#define SLAVE_ADDR  0x1D// 0b0011101 accelerometer
-#define MASTER_WRITE 0
-#define MASTER_READ 1
-
-extern     unsigned char out_x[2];
-extern     unsigned char out_y[2];
-extern     unsigned char out_z[2];
-extern int id;
-
-
-
-
-void i2c_master_setup(void);
-void i2c_master_start(void);
-void i2c_master_restart(void);
-void i2c_master_send(unsigned char byte);
-unsigned char i2c_master_recv(int ack);
-void i2c_master_ack(int val);
-void i2c_master_stop(void);
-void accelertometer_setup(void);
-void read_acc_id(void);
-void reac_acc_xyz(void);
-void i2c_debug_send(uint8_t byte);
-uint8_t i2c_debug_recv(void);
-
+/*
+ * Title: i2c lib CT header file
+ * author: CTa
+ * date: 01.12.2022
+ *  
+ */
+
+#include <stdint.h>
+
+#define SLAVE_ADDR  0x1D// 0b0011101 accelerometer
+#define MASTER_WRITE 0
+#define MASTER_READ 1
+
+#define I2C_FREQ 100000
+// I2CBRG = [1/(2*Fsck) - PGD]*Pblck - 2, PGD = 104 ns
+#define I2C_BRG(pbclk) ((pbclk) / (2 * I2C_FREQ) - (pbclk) / 1000000 * 104 / 1000 - 2)
+
+extern     unsigned char out_x[2];
+extern     unsigned char out_y[2];
+extern     unsigned char out_z[2];
+extern int id;
+
+
+
+
+void i2c_master_setup(void);
+void i2c_clock_changed(unsigned int pbclk);
+int i2c_master_start(void);
+int i2c_master_restart(void);
+int i2c_master_send(unsigned char byte);
+int i2c_master_recv(int ack);
+int i2c_master_ack(int val);
+int i2c_master_stop(void);
+void i2c_bus_recover(void);
+int i2c_write(unsigned char addr, unsigned char cmd, const unsigned char *data, int len);
+int i2c_read(unsigned char addr, unsigned char cmd, unsigned char *buf, int len);
+// Accelerometro MMA8652 (implementate in accel.c, sopra i2cbus.h): ritornano
+// DRV_OK o un codice di errore, id e out_x/out_y/out_z (MSB, LSB) restano
+// quelli dell'ultima lettura riuscita
+int accelertometer_setup(void);
+int read_acc_id(void);
+int reac_acc_xyz(void);
+void i2c_debug_send(uint8_t byte);
+uint8_t i2c_debug_recv(void);
+
@@ -0,0 +1,96 @@
+/*
+ * File:   i2cbus.c
+ *
+ * Tutto il traffico I2C parte dal main loop, quindi il bus non è mai
+ * conteso: l'arbitraggio serve a non occuparlo quando sta per arrivare
+ * la lettura del TSL2561. Il tempo di bus è misurato con il core timer
+ * attorno a ogni transazione, attese e recovery comprese.
+ */
+
+#include <stdio.h>
+#include "i2cbus.h"
+#include "i2c.h"
+#include "Timer.h"
+#include "Uart.h"
+#include "drv.h"
+
+typedef struct {
+    unsigned int transactions;
+    unsigned int bytes;         // byte sul bus, indirizzi e registro compresi
+    unsigned int busy_us;
+    unsigned int errors;
+    unsigned int late_max;      // ms di ritardo rispetto alla prenotazione
+} bus_stats_t;
+
+static const char *const names[I2CBUS_NUM_DEVICES] = { "TSL2561", "accelerometro" };
+static bus_stats_t stats[I2CBUS_NUM_DEVICES];
+static unsigned int window_start = 0; // millis() dell'ultimo rapporto
+
+static int owner = -1;      // dispositivo con la prenotazione, -1 nessuno
+static unsigned int reserved_at;
+
+static void account(int dev, unsigned int start, int bytes, int status) {
+    bus_stats_t *s = &stats[dev];
+
+    s->transactions++;
+    s->bytes += bytes;
+    s->busy_us += (core_ticks() - start) / (clock_sysclk() / 2000000);
+    if (status != DRV_OK)
+        s->errors++;
+    if (dev == owner) {
+        int late = (int)(millis() - reserved_at);
+        if (late > (int)s->late_max)
+            s->late_max = late;
+    }
+}
+
+int i2cbus_read(int dev, unsigned char addr, unsigned char cmd, unsigned char *buf, int len) {
+    unsigned int start = core_ticks();
+    int status = i2c_read(addr, cmd, buf, len);
+
+    account(dev, start, 3 + len, status); // indirizzo, registro, indirizzo dopo il restart
+    return status;
+}
+
+int i2cbus_write(int dev, unsigned char addr, unsigned char cmd, const unsigned char *data, int len) {
+    unsigned int start = core_ticks();
+    int status = i2c_write(addr, cmd, data, len);
+
+    account(dev, start, 2 + len, status);
+    return status;
+}
+
+void i2cbus_reserve(int dev, unsigned int at_ms) {
+    owner = dev;
+    reserved_at = at_ms;
+}
+
+void i2cbus_release(void) {
+    owner = -1;
+}
+
+int i2cbus_gap(int dev, int len) {
+    if (owner < 0 || owner == dev)
+        return 1;
+    // millis() può essere già avanti di quasi 1 ms: si arrotonda per eccesso
+    // e si aggiunge il margine
+    int need = ((3 + len) * I2CBUS_BYTE_US + 999) / 1000 + I2CBUS_GUARD_MS;
+    return (int)(reserved_at - millis()) > need;
+}
+
+void i2cbus_report(void) {
+    char buffer[112];
+    unsigned int window = millis() - window_start;
+
+    if (window == 0)
+        window = 1;
+    for (int i = 0; i < I2CBUS_NUM_DEVICES; i++) {
+        bus_stats_t *s = &stats[i];
+        unsigned int permille = s->busy_us / window; // us per ms
+        snprintf(buffer, sizeof(buffer), "I2C1 %s: %u transazioni, %u byte, occupato %u.%u%%, errori %u, ritardo max %u ms\r\n",
+                 names[i], s->transactions, s->bytes, permille / 10, permille % 10, s->errors, s->late_max);
+        UART4_WriteString(buffer);
+        *s = (bus_stats_t){ 0 };
+    }
+    window_start = millis(); // nuova finestra di misura
+}
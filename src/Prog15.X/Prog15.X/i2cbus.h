@@ -0,0 +1,40 @@
+/*
+ * File:   i2cbus.h
+ *
+ * Arbitraggio e contabilità del bus I2C1, condiviso da TSL2561 e
+ * accelerometro. Il TSL2561 integra in continuo e viene letto una volta
+ * per periodo di campionamento: il main loop prenota il bus per la
+ * lettura successiva e le transazioni dell'accelerometro entrano solo
+ * negli intervalli che finiscono prima della prenotazione, così non
+ * ritardano mai il campione di luce. Per ogni dispositivo vengono contati
+ * transazioni, byte e tempo di bus.
+ */
+
+#ifndef I2CBUS_H
+#define I2CBUS_H
+
+// Dispositivi sul bus
+#define I2CBUS_TSL2561      0
+#define I2CBUS_ACCEL        1
+#define I2CBUS_NUM_DEVICES  2
+
+#define I2CBUS_BYTE_US      90  // 9 bit a 100 kHz (I2C_FREQ)
+#define I2CBUS_GUARD_MS     1   // margine prima della prenotazione
+
+// i2c_read()/i2c_write() con la contabilità del dispositivo dev
+int i2cbus_read(int dev, unsigned char addr, unsigned char cmd, unsigned char *buf, int len);
+int i2cbus_write(int dev, unsigned char addr, unsigned char cmd, const unsigned char *data, int len);
+
+// Il dispositivo dev accederà al bus all'istante at_ms (millis()); la
+// prenotazione resta finché non viene spostata o rilasciata
+void i2cbus_reserve(int dev, unsigned int at_ms);
+void i2cbus_release(void);
+
+// 1 se una lettura di len byte di dev finisce prima della prenotazione
+// di un altro dispositivo
+int i2cbus_gap(int dev, int len);
+
+// Stampa l'utilizzo del bus per dispositivo dall'ultimo rapporto
+void i2cbus_report(void);
+
+#endif // I2CBUS_H
@@ -0,0 +1,147 @@
+/*
+ * File:   lcdgfx.c
+ *
+ * Renderer differenziale dell'LCD. Il testo di prima (clear, due righe
+ * di testo) costava circa 31 scritture e un clear da 1.6 ms a ogni frame;
+ * qui un frame tipico cambia poche cifre, la sparkline (un carattere per
+ * cella, i livelli sono glifi fissi caricati una volta) e una o due celle
+ * della barra più il glifo parziale: meno scritture e nessun clear.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "lcdgfx.h"
+#include "LCD.h"
+#include "Uart.h"
+#include "drv.h"
+
+#define GLYPHS      8
+#define GLYPH_ROWS  8
+#define BAR_COLUMNS (HLCD * 5)
+
+static char shadow[VLCD][HLCD];                 // contenuto della DDRAM
+static unsigned char cgram[GLYPHS][GLYPH_ROWS]; // contenuto della CGRAM
+static int shadow_valid = 0;
+static int cgram_valid = 0;
+
+static unsigned int history[LCDGFX_SPARK_CELLS];
+static int history_count = 0;
+
+static unsigned int frames = 0;
+static unsigned int writes = 0;
+static unsigned int glyph_uploads = 0;
+
+static int lcd_write(int addr, char c) {
+    writes++;
+    return writeLCD(addr, c);
+}
+
+// Carica i glifi diversi dalla copia in RAM
+static int upload_glyphs(unsigned char glyphs[GLYPHS][GLYPH_ROWS]) {
+    for (int g = 0; g < GLYPHS; g++) {
+        if (cgram_valid && memcmp(cgram[g], glyphs[g], GLYPH_ROWS) == 0)
+            continue;
+        if (lcd_write(LCDCMD, (g * GLYPH_ROWS & 0x3F) | 0x40) != DRV_OK) // setLCDG
+            return DRV_TIMEOUT;
+        for (int row = 0; row < GLYPH_ROWS; row++) {
+            if (lcd_write(LCDDATA, glyphs[g][row]) != DRV_OK)
+                return DRV_TIMEOUT;
+        }
+        memcpy(cgram[g], glyphs[g], GLYPH_ROWS);
+        glyph_uploads++;
+    }
+    cgram_valid = 1;
+    return DRV_OK;
+}
+
+// Scrive le celle cambiate; il cursore avanza da solo, quindi si
+// riposiziona solo dopo una cella saltata
+static int update_cells(char frame[VLCD][HLCD]) {
+    for (int row = 0; row < VLCD; row++) {
+        int cursor = -1;
+        for (int col = 0; col < HLCD; col++) {
+            if (shadow_valid && shadow[row][col] == frame[row][col])
+                continue;
+            if (cursor != col && lcd_write(LCDCMD, 0x80 | (row * 0x40 + col)) != DRV_OK) // setLCDC
+                return DRV_TIMEOUT;
+            if (lcd_write(LCDDATA, frame[row][col]) != DRV_OK)
+                return DRV_TIMEOUT;
+            shadow[row][col] = frame[row][col];
+            cursor = col + 1;
+        }
+    }
+    shadow_valid = 1;
+    return DRV_OK;
+}
+
+int lcdgfx_frame(unsigned int lux, unsigned int max_lux) {
+    unsigned char glyphs[GLYPHS][GLYPH_ROWS];
+    char frame[VLCD][HLCD];
+    char text[LCDGFX_TEXT_CELLS + 1];
+
+    // Glifi dei livelli: le prime level righe dal basso accese
+    for (int level = 1; level < GLYPHS; level++) {
+        for (int row = 0; row < GLYPH_ROWS; row++)
+            glyphs[level][row] = row >= GLYPH_ROWS - level ? 0x1F : 0x00;
+    }
+
+    // Barra: celle piene, una cella parziale, celle vuote
+    unsigned int columns = max_lux ? lux * BAR_COLUMNS / max_lux : 0;
+    if (columns > BAR_COLUMNS)
+        columns = BAR_COLUMNS;
+    unsigned int partial = columns % 5;
+    for (int col = 0; col < HLCD; col++)
+        frame[1][col] = col < (int)columns / 5 ? LCDGFX_FULL : ' ';
+    if (partial) {
+        frame[1][columns / 5] = LCDGFX_GLYPH(LCDGFX_GLYPH_BAR);
+        for (int row = 0; row < GLYPH_ROWS; row++)
+            glyphs[LCDGFX_GLYPH_BAR][row] = (0x1F << (5 - partial)) & 0x1F;
+    } else {
+        // Glifo non mostrato: resta quello caricato, nessuna scrittura
+        memcpy(glyphs[LCDGFX_GLYPH_BAR], cgram[LCDGFX_GLYPH_BAR], GLYPH_ROWS);
+    }
+
+    // Testo e sparkline, scalata sul massimo della finestra
+    snprintf(text, sizeof(text), "%5u lx", lux > 99999 ? 99999 : lux);
+    memcpy(frame[0], text, LCDGFX_TEXT_CELLS);
+    if (history_count == LCDGFX_SPARK_CELLS)
+        memmove(history, history + 1, sizeof(history) - sizeof(history[0]));
+    else
+        history_count++;
+    history[history_count - 1] = lux;
+
+    unsigned int peak = 0;
+    for (int i = 0; i < history_count; i++) {
+        if (history[i] > peak)
+            peak = history[i];
+    }
+    for (int i = 0; i < LCDGFX_SPARK_CELLS; i++) {
+        // Allineata a destra: il campione più recente nell'ultima cella
+        int h = i - (LCDGFX_SPARK_CELLS - history_count);
+        unsigned int level = h >= 0 && peak ? (history[h] * GLYPH_ROWS + peak / 2) / peak : 0;
+        char c = level == 0 ? ' ' : level == GLYPH_ROWS ? LCDGFX_FULL : LCDGFX_GLYPH(level);
+        frame[0][LCDGFX_TEXT_CELLS + i] = c;
+    }
+
+    frames++;
+    // Glifi prima delle celle: dopo la CGRAM il cursore va riposizionato
+    if (upload_glyphs(glyphs) != DRV_OK || update_cells(frame) != DRV_OK) {
+        shadow_valid = 0;
+        cgram_valid = 0;
+        return DRV_TIMEOUT;
+    }
+    return DRV_OK;
+}
+
+void lcdgfx_reset(void) {
+    history_count = 0;
+    shadow_valid = 0;
+}
+
+void lcdgfx_report(void) {
+    char buffer[80];
+
+    snprintf(buffer, sizeof(buffer), "Grafica LCD: %u frame, %u scritture (%u per frame), %u glifi caricati\r\n",
+             frames, writes, frames ? writes / frames : 0, glyph_uploads);
+    UART4_WriteString(buffer);
+}
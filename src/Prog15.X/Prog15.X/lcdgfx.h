@@ -0,0 +1,37 @@
+/*
+ * File:   lcdgfx.h
+ *
+ * Grafica sull'LCD 16x2 con i caratteri personalizzati della CGRAM.
+ * Prima riga: lux in cifre e sparkline degli ultimi frame (un campione per
+ * cella, 9 livelli). Seconda riga: barra dei lux rispetto a max_lux con
+ * risoluzione di una colonna di pixel (16 celle x 5 = 80 colonne).
+ * Il renderer tiene in RAM una copia di DDRAM e CGRAM e invia sul PMP solo
+ * le celle e i glifi cambiati rispetto al frame precedente.
+ */
+
+#ifndef LCDGFX_H
+#define LCDGFX_H
+
+// Celle della prima riga
+#define LCDGFX_TEXT_CELLS   8   // "%5u lx"
+#define LCDGFX_SPARK_CELLS  8
+
+// Caratteri della CGRAM: il controller li mostra sia ai codici 0-7 che
+// 8-15; si usano i secondi, così nessun carattere vale '\0'
+#define LCDGFX_GLYPH(n)     (0x08 + (n))
+#define LCDGFX_GLYPH_BAR    0   // ultima cella della barra, 1-4 colonne
+                                // glifi 1-7: livelli della sparkline
+#define LCDGFX_FULL         ((char)0xFF)    // cella piena nella ROM
+
+// Disegna un frame. Ritorna DRV_OK o il primo errore dell'LCD; dopo un
+// errore il frame successivo riscrive tutto
+int lcdgfx_frame(unsigned int lux, unsigned int max_lux);
+
+// Nuova sessione: svuota la sparkline e ridisegna tutte le celle al
+// prossimo frame (la CGRAM non cambia finché l'LCD resta alimentato)
+void lcdgfx_reset(void);
+
+// Stampa su UART frame disegnati e scritture sul PMP
+void lcdgfx_report(void);
+
+#endif // LCDGFX_H
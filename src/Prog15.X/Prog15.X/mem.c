@@ -0,0 +1,63 @@
+/*
+ * File:   mem.c
+ *
+ * Stack painting e margine di memoria
+ */
+
+#include <stdio.h>
+#include "mem.h"
+#include "Uart.h"
+
+// Simboli del linker script di XC32: lo stack cresce verso il basso da
+// _stack fino a _splim, sopra heap e variabili statiche
+extern char _splim[];
+extern char _stack[];
+
+volatile unsigned int mem_isr_sp_min = 0xFFFFFFFF;
+
+static unsigned int current_sp(void) {
+    unsigned int sp;
+    __asm__ volatile("move %0, $sp" : "=r"(sp));
+    return sp;
+}
+
+void mem_paint_stack(void) {
+    unsigned int *p = (unsigned int *)_splim;
+    unsigned int *end = (unsigned int *)(current_sp() - MEM_PAINT_MARGIN);
+
+    while (p < end)
+        *p++ = MEM_STACK_PATTERN;
+}
+
+unsigned int mem_stack_used(void) {
+    unsigned int *p = (unsigned int *)_splim;
+
+    while (p < (unsigned int *)_stack && *p == MEM_STACK_PATTERN)
+        p++;
+    return _stack - (char *)p;
+}
+
+void mem_report(void) {
+    char buffer[80];
+    unsigned int size = _stack - _splim;
+    unsigned int used = mem_stack_used();
+
+    snprintf(buffer, sizeof(buffer), "Stack: %u byte (0x%08X-0x%08X), SP attuale 0x%08X\r\n",
+             size, (unsigned int)_splim, (unsigned int)_stack, current_sp());
+    UART4_WriteString(buffer);
+    snprintf(buffer, sizeof(buffer), "Usati al massimo: %u byte, margine: %u byte\r\n", used, size - used);
+    UART4_WriteString(buffer);
+    if (mem_isr_sp_min != 0xFFFFFFFF) {
+        unsigned int entry = (unsigned int)_stack - mem_isr_sp_min;
+        snprintf(buffer, sizeof(buffer), "SP minimo all'ingresso in interrupt: 0x%08X (%u byte)\r\n",
+                 mem_isr_sp_min, entry);
+        UART4_WriteString(buffer);
+        // Il punto più basso del pattern sovrascritto è sotto quello SP
+        // solo per lo stack delle ISR (o per un main più profondo senza
+        // interrupt): la differenza è un limite superiore
+        snprintf(buffer, sizeof(buffer), "Stack delle ISR: al massimo %u byte\r\n",
+                 used > entry ? used - entry : 0);
+        UART4_WriteString(buffer);
+    }
+    UART4_WriteString("RAM statica per file e simbolo: make ramreport\r\n");
+}
@@ -0,0 +1,40 @@
+/*
+ * File:   mem.h
+ *
+ * Misura dello stack: all'avvio la parte libera viene riempita con un
+ * pattern (stack painting), il punto più basso in cui il pattern è stato
+ * sovrascritto dà il massimo utilizzo. Le ISR condividono lo stack del
+ * main: MEM_ISR_PROBE() registra lo SP più basso all'ingresso in
+ * interrupt, cioè quanto era profondo il main quando è stato interrotto.
+ * Lo stack usato dalle ISR è al massimo la differenza fra il massimo
+ * utilizzo e questa profondità.
+ * L'occupazione della RAM statica si ricava dal map file con
+ * "make ramreport".
+ */
+
+#ifndef MEM_H
+#define MEM_H
+
+#define MEM_STACK_PATTERN   0xA5A5A5A5
+#define MEM_PAINT_MARGIN    64  // byte sotto lo SP corrente lasciati intatti
+
+extern volatile unsigned int mem_isr_sp_min;
+
+// Da chiamare in testa a ogni ISR: misura lo SP del contesto interrotto
+#define MEM_ISR_PROBE() do {                                        \
+    unsigned int _sp;                                               \
+    __asm__ volatile("move %0, $sp" : "=r"(_sp));                   \
+    if (_sp < mem_isr_sp_min)                                       \
+        mem_isr_sp_min = _sp;                                       \
+} while (0)
+
+// Riempie lo stack libero con il pattern, da chiamare all'inizio di main()
+void mem_paint_stack(void);
+
+// Byte di stack usati al massimo dall'avvio
+unsigned int mem_stack_used(void);
+
+// Stampa dimensione, massimo utilizzo e margine dello stack
+void mem_report(void);
+
+#endif // MEM_H
@@ -51,17 +51,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=LCD.c Timer.c i2c.c Uart.c newmain.c ADC.c Pin.c spi.c TSL2561.c Audio_PMW.c
+SOURCEFILES_QUOTED_IF_SPACED=LCD.c Timer.c i2c.c Uart.c newmain.c ADC.c Pin.c spi.c TSL2561.c Audio_PMW.c events.c button.c boot.c codec.c datalog.c stream.c clock.c drv.c capture.c mem.c sfdp.c samples.c settings.c lcdgfx.c flashcache.c flicker.c goertzel.c accel.c i2cbus.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/LCD.o ${OBJECTDIR}/Timer.o ${OBJECTDIR}/i2c.o ${OBJECTDIR}/Uart.o ${OBJECTDIR}/newmain.o ${OBJECTDIR}/ADC.o ${OBJECTDIR}/Pin.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/TSL2561.o ${OBJECTDIR}/Audio_PMW.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/LCD.o.d ${OBJECTDIR}/Timer.o.d ${OBJECTDIR}/i2c.o.d ${OBJECTDIR}/Uart.o.d ${OBJECTDIR}/newmain.o.d ${OBJECTDIR}/ADC.o.d ${OBJECTDIR}/Pin.o.d ${OBJECTDIR}/spi.o.d ${OBJECTDIR}/TSL2561.o.d ${OBJECTDIR}/Audio_PMW.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/LCD.o ${OBJECTDIR}/Timer.o ${OBJECTDIR}/i2c.o ${OBJECTDIR}/Uart.o ${OBJECTDIR}/newmain.o ${OBJECTDIR}/ADC.o ${OBJECTDIR}/Pin.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/TSL2561.o ${OBJECTDIR}/Audio_PMW.o ${OBJECTDIR}/events.o ${OBJECTDIR}/button.o ${OBJECTDIR}/boot.o ${OBJECTDIR}/codec.o ${OBJECTDIR}/datalog.o ${OBJECTDIR}/stream.o ${OBJECTDIR}/clock.o ${OBJECTDIR}/drv.o ${OBJECTDIR}/capture.o ${OBJECTDIR}/mem.o ${OBJECTDIR}/sfdp.o ${OBJECTDIR}/samples.o ${OBJECTDIR}/settings.o ${OBJECTDIR}/lcdgfx.o ${OBJECTDIR}/flashcache.o ${OBJECTDIR}/flicker.o ${OBJECTDIR}/goertzel.o ${OBJECTDIR}/accel.o ${OBJECTDIR}/i2cbus.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/LCD.o.d ${OBJECTDIR}/Timer.o.d ${OBJECTDIR}/i2c.o.d ${OBJECTDIR}/Uart.o.d ${OBJECTDIR}/newmain.o.d ${OBJECTDIR}/ADC.o.d ${OBJECTDIR}/Pin.o.d ${OBJECTDIR}/spi.o.d ${OBJECTDIR}/TSL2561.o.d ${OBJECTDIR}/Audio_PMW.o.d ${OBJECTDIR}/events.o.d ${OBJECTDIR}/button.o.d ${OBJECTDIR}/boot.o.d ${OBJECTDIR}/codec.o.d ${OBJECTDIR}/datalog.o.d ${OBJECTDIR}/stream.o.d ${OBJECTDIR}/clock.o.d ${OBJECTDIR}/drv.o.d ${OBJECTDIR}/capture.o.d ${OBJECTDIR}/mem.o.d ${OBJECTDIR}/sfdp.o.d ${OBJECTDIR}/samples.o.d ${OBJECTDIR}/settings.o.d ${OBJECTDIR}/lcdgfx.o.d ${OBJECTDIR}/flashcache.o.d ${OBJECTDIR}/flicker.o.d ${OBJECTDIR}/goertzel.o.d ${OBJECTDIR}/accel.o.d ${OBJECTDIR}/i2cbus.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/LCD.o ${OBJECTDIR}/Timer.o ${OBJECTDIR}/i2c.o ${OBJECTDIR}/Uart.o ${OBJECTDIR}/newmain.o ${OBJECTDIR}/ADC.o ${OBJECTDIR}/Pin.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/TSL2561.o ${OBJECTDIR}/Audio_PMW.o
+OBJECTFILES=${OBJECTDIR}/LCD.o ${OBJECTDIR}/Timer.o ${OBJECTDIR}/i2c.o ${OBJECTDIR}/Uart.o ${OBJECTDIR}/newmain.o ${OBJECTDIR}/ADC.o ${OBJECTDIR}/Pin.o ${OBJECTDIR}/spi.o ${OBJECTDIR}/TSL2561.o ${OBJECTDIR}/Audio_PMW.o ${OBJECTDIR}/events.o ${OBJECTDIR}/button.o ${OBJECTDIR}/boot.o ${OBJECTDIR}/codec.o ${OBJECTDIR}/datalog.o ${OBJECTDIR}/stream.o ${OBJECTDIR}/clock.o ${OBJECTDIR}/drv.o ${OBJECTDIR}/capture.o ${OBJECTDIR}/mem.o ${OBJECTDIR}/sfdp.o ${OBJECTDIR}/samples.o ${OBJECTDIR}/settings.o ${OBJECTDIR}/lcdgfx.o ${OBJECTDIR}/flashcache.o ${OBJECTDIR}/flicker.o ${OBJECTDIR}/goertzel.o ${OBJECTDIR}/accel.o ${OBJECTDIR}/i2cbus.o
 
 # Source Files
-SOURCEFILES=LCD.c Timer.c i2c.c Uart.c newmain.c ADC.c Pin.c spi.c TSL2561.c Audio_PMW.c
+SOURCEFILES=LCD.c Timer.c i2c.c Uart.c newmain.c ADC.c Pin.c spi.c TSL2561.c Audio_PMW.c events.c button.c boot.c codec.c datalog.c stream.c clock.c drv.c capture.c mem.c sfdp.c samples.c settings.c lcdgfx.c flashcache.c flicker.c goertzel.c accel.c i2cbus.c
 
 
 
@@ -161,6 +161,120 @@ ${OBJECTDIR}/Audio_PMW.o: Audio_PMW.c  .generated_files/flags/default/6affebce16
 	@${RM} ${OBJECTDIR}/Audio_PMW.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Audio_PMW.o.d" -o ${OBJECTDIR}/Audio_PMW.o Audio_PMW.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/events.o: events.c  .generated_files/flags/default/648f89e0a92f527c653d425800b9a37c25fd28b7 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/events.o.d 
+	@${RM} ${OBJECTDIR}/events.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/events.o.d" -o ${OBJECTDIR}/events.o events.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/button.o: button.c  .generated_files/flags/default/07bbd1fa80b9768f76c8da1095a811dbcf22807e .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/button.o.d 
+	@${RM} ${OBJECTDIR}/button.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/button.o.d" -o ${OBJECTDIR}/button.o button.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/boot.o: boot.c  .generated_files/flags/default/21f8e2829b15d542600d5c0041e39f2ec312f982 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/boot.o.d 
+	@${RM} ${OBJECTDIR}/boot.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/boot.o.d" -o ${OBJECTDIR}/boot.o boot.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/codec.o: codec.c  .generated_files/flags/default/0bd038bd00e45e1e3d9d0018304bdae9076aa58f .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/codec.o.d 
+	@${RM} ${OBJECTDIR}/codec.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/codec.o.d" -o ${OBJECTDIR}/codec.o codec.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/datalog.o: datalog.c  .generated_files/flags/default/444e4374755783ffa53372d3180fef5714e59d67 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/datalog.o.d 
+	@${RM} ${OBJECTDIR}/datalog.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/datalog.o.d" -o ${OBJECTDIR}/datalog.o datalog.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/stream.o: stream.c  .generated_files/flags/default/2c910910be8330a34471fd45dfa006a456fb16dc .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/stream.o.d 
+	@${RM} ${OBJECTDIR}/stream.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/stream.o.d" -o ${OBJECTDIR}/stream.o stream.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/clock.o: clock.c  .generated_files/flags/default/337ab5c1e5caa5a1bf561a8ee65cd02088141971 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/clock.o.d 
+	@${RM} ${OBJECTDIR}/clock.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/clock.o.d" -o ${OBJECTDIR}/clock.o clock.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/drv.o: drv.c  .generated_files/flags/default/b7901394b5d8f6bbc2415883f318f7b4b395bc7a .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/drv.o.d 
+	@${RM} ${OBJECTDIR}/drv.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/drv.o.d" -o ${OBJECTDIR}/drv.o drv.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/capture.o: capture.c  .generated_files/flags/default/21dcec5e16154a49d37d3b26f8564ac6bf1cd217 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/capture.o.d 
+	@${RM} ${OBJECTDIR}/capture.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/capture.o.d" -o ${OBJECTDIR}/capture.o capture.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/mem.o: mem.c  .generated_files/flags/default/969a7b1fbcc5718ffb0565dc332bb97f036108a8 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/mem.o.d 
+	@${RM} ${OBJECTDIR}/mem.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/mem.o.d" -o ${OBJECTDIR}/mem.o mem.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/sfdp.o: sfdp.c  .generated_files/flags/default/c906f374a6d4a63bd6a6b89f67d99a9b5526156a .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/sfdp.o.d 
+	@${RM} ${OBJECTDIR}/sfdp.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/sfdp.o.d" -o ${OBJECTDIR}/sfdp.o sfdp.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/samples.o: samples.c  .generated_files/flags/default/2de825961570ec5cf5cd29065a5409ed7eed8084 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/samples.o.d 
+	@${RM} ${OBJECTDIR}/samples.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/samples.o.d" -o ${OBJECTDIR}/samples.o samples.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/settings.o: settings.c  .generated_files/flags/default/8b6c1ac68fd6fd2fb874175f75b78e639c61f556 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/settings.o.d 
+	@${RM} ${OBJECTDIR}/settings.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/settings.o.d" -o ${OBJECTDIR}/settings.o settings.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/lcdgfx.o: lcdgfx.c  .generated_files/flags/default/65036a2164372b29065ef211fb64afe4fd6cfbb4 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/lcdgfx.o.d 
+	@${RM} ${OBJECTDIR}/lcdgfx.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/lcdgfx.o.d" -o ${OBJECTDIR}/lcdgfx.o lcdgfx.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/flashcache.o: flashcache.c  .generated_files/flags/default/66ab069f269341ca758711429b7eb1fd98d18d27 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/flashcache.o.d 
+	@${RM} ${OBJECTDIR}/flashcache.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/flashcache.o.d" -o ${OBJECTDIR}/flashcache.o flashcache.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/flicker.o: flicker.c  .generated_files/flags/default/176dfec9f1d1bbde91a836a29e1b469a7b901c7a .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/flicker.o.d 
+	@${RM} ${OBJECTDIR}/flicker.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/flicker.o.d" -o ${OBJECTDIR}/flicker.o flicker.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/goertzel.o: goertzel.c  .generated_files/flags/default/6729cc96435ad27ddfb80585a79a05f9c665217a .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/goertzel.o.d 
+	@${RM} ${OBJECTDIR}/goertzel.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/goertzel.o.d" -o ${OBJECTDIR}/goertzel.o goertzel.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/accel.o: accel.c  .generated_files/flags/default/bdabc5c1385b7999185b73e30050784cdd91afa6 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/accel.o.d 
+	@${RM} ${OBJECTDIR}/accel.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/accel.o.d" -o ${OBJECTDIR}/accel.o accel.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/i2cbus.o: i2cbus.c  .generated_files/flags/default/8a7a27cb602e0324fb4b393c3f53c6f357297607 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/i2cbus.o.d 
+	@${RM} ${OBJECTDIR}/i2cbus.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG -D__MPLAB_DEBUGGER_PK3=1  -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/i2cbus.o.d" -o ${OBJECTDIR}/i2cbus.o i2cbus.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 else
 ${OBJECTDIR}/LCD.o: LCD.c  .generated_files/flags/default/c225443883b5cd5082578c10f117523548e4c349 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
 	@${MKDIR} "${OBJECTDIR}" 
@@ -222,6 +336,120 @@ ${OBJECTDIR}/Audio_PMW.o: Audio_PMW.c  .generated_files/flags/default/540119745c
 	@${RM} ${OBJECTDIR}/Audio_PMW.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/Audio_PMW.o.d" -o ${OBJECTDIR}/Audio_PMW.o Audio_PMW.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/events.o: events.c  .generated_files/flags/default/3b98c05410c51932788c630a248df5b65f5d62f6 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/events.o.d 
+	@${RM} ${OBJECTDIR}/events.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/events.o.d" -o ${OBJECTDIR}/events.o events.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/button.o: button.c  .generated_files/flags/default/263457c633b77592ba9d19e17b704390f3ec629d .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/button.o.d 
+	@${RM} ${OBJECTDIR}/button.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/button.o.d" -o ${OBJECTDIR}/button.o button.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/boot.o: boot.c  .generated_files/flags/default/e6f99b240a2fb4bfc0ea67a0894fe8c79812502b .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/boot.o.d 
+	@${RM} ${OBJECTDIR}/boot.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/boot.o.d" -o ${OBJECTDIR}/boot.o boot.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/codec.o: codec.c  .generated_files/flags/default/cc05bc281a6013dd79d919f06424c2e023c5a51d .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/codec.o.d 
+	@${RM} ${OBJECTDIR}/codec.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/codec.o.d" -o ${OBJECTDIR}/codec.o codec.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/datalog.o: datalog.c  .generated_files/flags/default/9abd8c66a70830638dca5039aea4339398dc651d .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/datalog.o.d 
+	@${RM} ${OBJECTDIR}/datalog.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/datalog.o.d" -o ${OBJECTDIR}/datalog.o datalog.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/stream.o: stream.c  .generated_files/flags/default/d141d8fcf0946e981a229e329ca188b2fe4ee7c5 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/stream.o.d 
+	@${RM} ${OBJECTDIR}/stream.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/stream.o.d" -o ${OBJECTDIR}/stream.o stream.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/clock.o: clock.c  .generated_files/flags/default/61807f9edb8c630e5d2c480a9e38aca811871093 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/clock.o.d 
+	@${RM} ${OBJECTDIR}/clock.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/clock.o.d" -o ${OBJECTDIR}/clock.o clock.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/drv.o: drv.c  .generated_files/flags/default/d4eadda24520476c57f332ff8860838a1a2a9991 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/drv.o.d 
+	@${RM} ${OBJECTDIR}/drv.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/drv.o.d" -o ${OBJECTDIR}/drv.o drv.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/capture.o: capture.c  .generated_files/flags/default/cbd44502abc9515fec565c5b03e0b93ffe81b7e1 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/capture.o.d 
+	@${RM} ${OBJECTDIR}/capture.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/capture.o.d" -o ${OBJECTDIR}/capture.o capture.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/mem.o: mem.c  .generated_files/flags/default/6efb12df2a87005d5db635a930f605f899a3dbd6 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/mem.o.d 
+	@${RM} ${OBJECTDIR}/mem.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/mem.o.d" -o ${OBJECTDIR}/mem.o mem.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/sfdp.o: sfdp.c  .generated_files/flags/default/554e25c0f7a467f87e6268be6305d848dbb59d04 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/sfdp.o.d 
+	@${RM} ${OBJECTDIR}/sfdp.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/sfdp.o.d" -o ${OBJECTDIR}/sfdp.o sfdp.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/samples.o: samples.c  .generated_files/flags/default/5b7e91ffdce9bb802fe286d9b10d0aed817c2358 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/samples.o.d 
+	@${RM} ${OBJECTDIR}/samples.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/samples.o.d" -o ${OBJECTDIR}/samples.o samples.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/settings.o: settings.c  .generated_files/flags/default/47685a34d577aaa7a5599c0d619db1fa8e419390 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/settings.o.d 
+	@${RM} ${OBJECTDIR}/settings.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/settings.o.d" -o ${OBJECTDIR}/settings.o settings.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/lcdgfx.o: lcdgfx.c  .generated_files/flags/default/15fcf4a52a145070b691b2f91f2684b4caac751c .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/lcdgfx.o.d 
+	@${RM} ${OBJECTDIR}/lcdgfx.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/lcdgfx.o.d" -o ${OBJECTDIR}/lcdgfx.o lcdgfx.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/flashcache.o: flashcache.c  .generated_files/flags/default/8d47bfcbf4e4db387dfc2e4e9fb813ab5923fe03 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/flashcache.o.d 
+	@${RM} ${OBJECTDIR}/flashcache.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/flashcache.o.d" -o ${OBJECTDIR}/flashcache.o flashcache.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/flicker.o: flicker.c  .generated_files/flags/default/6fcedbd62e5f02db773ffd01638048cd4cdc67cb .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/flicker.o.d 
+	@${RM} ${OBJECTDIR}/flicker.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/flicker.o.d" -o ${OBJECTDIR}/flicker.o flicker.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/goertzel.o: goertzel.c  .generated_files/flags/default/933f06a1405c5315144baf2c13435722dd517c94 .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/goertzel.o.d 
+	@${RM} ${OBJECTDIR}/goertzel.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/goertzel.o.d" -o ${OBJECTDIR}/goertzel.o goertzel.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/accel.o: accel.c  .generated_files/flags/default/c6a7a0c529f04198d0e9d6b11b6a1f06b551ebdf .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/accel.o.d 
+	@${RM} ${OBJECTDIR}/accel.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/accel.o.d" -o ${OBJECTDIR}/accel.o accel.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/i2cbus.o: i2cbus.c  .generated_files/flags/default/f96a8e8fb0a5acb525a00f139f73dcd4fd562c2b .generated_files/flags/default/da39a3ee5e6b4b0d3255bfef95601890afd80709
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/i2cbus.o.d 
+	@${RM} ${OBJECTDIR}/i2cbus.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/i2cbus.o.d" -o ${OBJECTDIR}/i2cbus.o i2cbus.c    -DXPRJ_default=$(CND_CONF)    $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 endif
 
 # ------------------------------------------------------------------------------------
@@ -1,228 +1,469 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <p32xxxx.h>
-
-#include "Uart.h"
-#include "LCD.h"
-#include "i2c.h"
-#include "Timer.h"
-#include "ADC.h"
-#include "Audio_PMW.h"
-#include "spi.h"
-#include "Pin.h"
-#include "TSL2561.h"    
-
-// Dichiarazioni delle funzioni
-void init_hardware(void);
-void init_menu(void);
-void start_monitoring(void);
-void stop_monitoring(void);
-void display_last_detection(void);
-void reset_last_detection(void);
-void beep(void);
-void BTNC_Interrupt_Init(void);
-void update_leds(int lux);
-
-// Configurazione FUSE del microcontrollore
-#pragma config FNOSC = FRCPLL 
-#pragma config FSOSCEN = OFF 
-#pragma config POSCMOD = XT 
-#pragma config OSCIOFNC = ON 
-#pragma config FPBDIV = DIV_2 
-#pragma config FPLLIDIV = DIV_2 
-#pragma config FPLLMUL = MUL_20 
-#pragma config FPLLODIV = DIV_2 
-#pragma config JTAGEN = OFF 
-#pragma config FWDTEN = OFF
-
-// Definizioni per LED RGB
-#define LED_RGB_RED     LATDbits.LATD2
-#define LED_RGB_GREEN   LATDbits.LATD12
-#define LED_RGB_BLUE    LATDbits.LATD3
-
-// Numero di LED sulla porta A
-#define NUM_LEDS 8
-#define MAX_LUX 1800 // Valore massimo di LUX per 8 LED accesi
-#define MAX_COMMAND_LENGTH 20
-static char uart_command[MAX_COMMAND_LENGTH];
-
-volatile unsigned int last_lux = 0; // Ultima misura LUX
-volatile int monitoring = 0;        // Flag monitoraggio attivo
-char stringaSuLCD[16]; // Buffer per scritte su LCD
-volatile int interrupt_triggered = 0;  // Flag per indicare che l'interrupt  stato attivato
-
-
-// Interrupt INT4, imposta la flag per indicare che l'interrupt  stato attivato
-void __attribute__((interrupt(ipl1AUTO), vector(_EXTERNAL_4_VECTOR))) ButtonInterrupt(void) {
-    if (monitoring)
-        interrupt_triggered = 1;  
-    Delayms(100);
-    IFS0bits.INT4IF = 0;  // Pulisce il flag dell'interrupt
-}
-
-int main(int argc, char** argv) {
-    init_hardware();
-    init_menu();
-    
-    while (1) {
-        if (interrupt_triggered) {
-            char debug_buffer[50];
-            snprintf(debug_buffer, sizeof(debug_buffer), "Interrupt Triggered. Last lux: %d\r\n", last_lux);
-            UART4_WriteString(debug_buffer);  
-            
-            // Scrive l'ultimo valore di lux nella memoria flash
-            EraseFlash();
-            writeFlashMem(0x00, (unsigned char)(last_lux & 0xFF));  // Byte meno significativo
-            writeFlashMem(0x01, (unsigned char)((last_lux >> 8) & 0xFF));  // Byte pi significativo        
-
-            stop_monitoring();
-            // Reset del flag
-            interrupt_triggered = 0;
-        }
-        if (monitoring) {
-            int lux = (int)TSL2561_read_lux();
-            last_lux = lux;
-            update_leds(lux);  
-            
-            // Aggiorna LCD
-            cmdLCD(0x01); // Clear display
-            cmdLCD(0x80); // Prima riga
-            snprintf(stringaSuLCD, sizeof(stringaSuLCD), "Light:%d LUX", lux);
-            putsLCD(stringaSuLCD);    
-            cmdLCD(0xC0); // Seconda riga
-            snprintf(stringaSuLCD, sizeof(stringaSuLCD), "LED accesi:%d", (lux * NUM_LEDS) / MAX_LUX);
-            putsLCD(stringaSuLCD);
-            Delayms(500);
-        }
-    }
-    return 0;
-}
-
-//Inizializzazione hardware
-void init_hardware() {
-    MultiVector_mode();
-    _nop();
-    Timer2_init();
-    Init_pins();
-    BTNC_Interrupt_Init();
-    UART_ConfigurePins();
-    UART_ConfigureUart();
-    audio_init(); 
-    init_ADC();
-    initLCD();
-    i2c_master_setup();
-    TSL2561_init(); // Inizializza sensore di luce
-    initSPI1(); // Inizializza SPI per Flash
-    EraseFlash(); // cancella la memoria flash
-    
-    
-    // LED RGB Verde all'accensione
-    LED_RGB_RED = 0;
-    LED_RGB_GREEN = 1;
-    LED_RGB_BLUE = 0;
-}
-
-
-void BTNC_Interrupt_Init(void) {
-    INT4R = 0x04;   
-    INTCONbits.INT4EP = 0;  // Impostazione fronte di discesa
-    // Configura priorit e flag dell'interrupt
-    IPC4bits.INT4IP = 1;    // Imposta priorit alta
-    IPC4bits.INT4IS = 0;     // EXT0 sub-priority 0
-    IFS0bits.INT4IF = 0;    // Pulisce il flag dell'interrupt
-    IEC0bits.INT4IE = 1;    // Abilita l'interrupt INT4
-}
-
-// Menu iniziale su UART
-void init_menu(void) {
-    UART4_WriteString("Menu:\r\n");
-    UART4_WriteString("1. Avvia monitoraggio luce ambientale\r\n");
-    UART4_WriteString("2. Visualizza ultima detezione luminosa\r\n");
-    UART4_WriteString("3. Reset ultima detezione\r\n");
-    
-    UART4_ReadString(uart_command, MAX_COMMAND_LENGTH);
-    uart_command[MAX_COMMAND_LENGTH - 1] = '\0'; // assicurare terminazione
-
-    if (strcmp(uart_command, "1") == 0) {
-        start_monitoring();
-        UART4_FlushBuffer();
-    } else if (strcmp(uart_command, "2") == 0){
-        display_last_detection();
-        UART4_FlushBuffer();
-        init_menu();
-    } else if (strcmp(uart_command, "3") == 0) {
-        reset_last_detection();
-        UART4_FlushBuffer();
-        init_menu();
-    } else {
-        UART4_WriteString("Errore: comando non valido\r\n");
-        UART4_FlushBuffer();
-        init_menu();
-    }
-
-
-}
-
-// Funzione 1: Avvio monitoraggio
-void start_monitoring(void) {
-    monitoring = 1;
-    beep(); // Beep iniziale
-    LED_RGB_GREEN = 0;
-    LED_RGB_BLUE = 1;
-}
-
-// Interrompe il monitoraggio e torna al menu
-void stop_monitoring(void) {
-    monitoring = 0;
-    LED_RGB_BLUE = 0;
-    LED_RGB_GREEN = 1;
-    init_menu();
-}
-
-// Funzione 2: Visualizza ultima detezione
-void display_last_detection(void) {
-    // Legge i due byte consecutivi dalla memoria flash
-    int low_byte = readFlashMem(0x00);         // Byte meno significativo
-    int high_byte = readFlashMem(0x01);        // Byte pi significativo
-
-    // Ricostruisce il valore 16-bit
-    int stored_lux = (high_byte << 8) | low_byte;
-    
-    // Prepara il messaggio da visualizzare
-    char buffer[50];
-    sprintf(buffer, "Last Light: %d LUX\r\n", stored_lux);
-
-    // Invia il messaggio tramite UART
-    UART4_WriteString(buffer);
-}
-
-// Funzione 3: Reset ultima detezione
-void reset_last_detection(void) {
-    // Cancella la memoria flash
-    UART4_WriteString("Inizio cancellazione flash...\r\n");
-    EraseFlash();
-    UART4_WriteString("Ultima detezione resettata.\r\n");
-}
-
-// Funzione per aggiornare i LED in base al valore di Lux
-void update_leds(int lux) {
-    // Calcola il numero di LED da accendere in base al valore di lux
-    int num_leds = NUM_LEDS - (lux * NUM_LEDS) / MAX_LUX;
-
-    // Aggiorna i LED
-    unsigned char pattern = 0x00;
-    for (int i = 0; i < num_leds; i++) {
-        pattern |= (1 << i);  // Accende il LED corrispondente
-    }
-
-    // Imposta il pattern sui LED (porta A)
-    LATA = (LATA & 0xFF00) | pattern;
-}
-
-// Breve beep a 10kHz, 50% duty
-void beep(){ 
-    OC1CONbits.ON = 1;            // Accende OC1     
-    Delayms(1000);
-    OC1CONbits.ON = 0; 
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <p32xxxx.h>
+
+#include "Uart.h"
+#include "LCD.h"
+#include "i2c.h"
+#include "Timer.h"
+#include "ADC.h"
+#include "Audio_PMW.h"
+#include "spi.h"
+#include "Pin.h"
+#include "TSL2561.h"    
+#include "events.h"
+#include "button.h"
+#include "boot.h"
+#include "datalog.h"
+#include "stream.h"
+#include "clock.h"
+#include "drv.h"
+#include "capture.h"
+#include "mem.h"
+#include "samples.h"
+#include "settings.h"
+#include "lcdgfx.h"
+#include "flashcache.h"
+#include "flicker.h"
+#include "i2cbus.h"
+#include "accel.h"
+
+// Dichiarazioni delle funzioni
+void app_init(void);
+int app_step(void);
+void init_hardware(void);
+void init_menu(void);
+void start_monitoring(void);
+void stop_monitoring(void);
+void display_last_detection(void);
+void reset_last_detection(void);
+void beep(void);
+int beep_poll(void);
+void update_leds(int lux);
+void menu_handle_char(char c);
+void execute_command(void);
+void execute_set(char *args);
+void save_last_detection(void);
+void sample_sensor(void);
+int update_display(void);
+int consume_samples(void);
+
+// Configurazione FUSE del microcontrollore (valori riportati anche in clock.h)
+#pragma config FNOSC = FRCPLL 
+#pragma config FSOSCEN = OFF 
+#pragma config POSCMOD = XT 
+#pragma config OSCIOFNC = ON 
+#pragma config FPBDIV = DIV_2 
+#pragma config FPLLIDIV = DIV_2 
+#pragma config FPLLMUL = MUL_20 
+#pragma config FPLLODIV = DIV_2 
+#pragma config JTAGEN = OFF 
+#pragma config FWDTEN = OFF
+
+// Definizioni per LED RGB
+#define LED_RGB_RED     LATDbits.LATD2
+#define LED_RGB_GREEN   LATDbits.LATD12
+#define LED_RGB_BLUE    LATDbits.LATD3
+
+// Numero di LED sulla porta A; lux a LED tutti spenti, periodo di
+// campionamento e aggiornamento dell'LCD sono impostazioni (settings.h)
+#define NUM_LEDS 8
+#define BEEP_MS 1000
+#define MAX_COMMAND_LENGTH 32 // "set <nome> <valore>"
+static char uart_command[MAX_COMMAND_LENGTH];
+static int command_length = 0;
+
+volatile unsigned int last_lux = 0; // Ultima misura LUX
+volatile int monitoring = 0;        // Flag monitoraggio attivo
+static int booted = 0;              // Inizializzazioni differite completate
+static int boot_reported = 0;       // Traguardi di avvio già trasmessi
+static sample_reader_t led_reader;  // Consumatori del ring dei campioni in newmain
+static sample_reader_t lcd_reader;
+static unsigned int lcd_time;       // millis() dell'ultimo aggiornamento LCD
+static unsigned int sample_period;  // ms fra due letture del TSL2561
+static unsigned int beep_time;      // millis() di inizio del beep in corso
+static int beeping = 0;
+
+
+int main(int argc, char** argv) {
+    mem_paint_stack(); // prima di ogni altra chiamata
+    app_init();
+    
+    // Tutto il lavoro parte dagli eventi accodati dalle ISR
+    while (1)
+        app_step();
+    return 0;
+}
+
+void app_init(void) {
+    init_hardware();
+    init_menu();
+    boot_milestone("menu");
+}
+
+// Un'iterazione del main loop, ritorna 1 se ha gestito un evento
+// (separata da main() per il replay su host, vedi src/replay)
+int app_step(void) {
+    event_t ev;
+
+    if (!booted && boot_poll()) {
+        // Prima lettura appena il sensore è pronto
+        last_lux = TSL2561_read_lux();
+        boot_milestone("first sample");
+        booted = 1;
+    }
+    // Il rapporto di avvio parte quando la seriale è libera, senza attese
+    if (booted && !boot_reported)
+        boot_reported = boot_report();
+    drv_loop_mark();
+    // Prima gli eventi (acquisizione compresa), poi i consumatori dei campioni
+    // L'analisi del flicker acquisisce da AN2, fuori dal ring dei campioni;
+    // l'accelerometro usa il bus I2C fra due letture del TSL2561
+    if (!event_pop(&ev))
+        return consume_samples() | flicker_poll() | accel_poll() | beep_poll();
+
+    switch (ev.type) {
+    case EV_BUTTON:
+        if (monitoring && capture_active()) {
+            capture_trigger();
+        } else if (monitoring) {
+            if (stream_active())
+                stream_stop();
+            datalog_flush();
+            save_last_detection();
+            stop_monitoring();
+        }
+        break;
+    case EV_UART_RX:
+        if (flicker_active()) {
+            // Un tasto qualsiasi termina l'analisi del flicker
+            flicker_stop();
+            init_menu();
+        } else if (!monitoring) {
+            menu_handle_char((char)ev.data);
+        } else if (capture_active() && ev.data > ' ') {
+            // In cattura BTNC è il trigger, si termina con un tasto
+            capture_stop();
+            datalog_flush();
+            stop_monitoring();
+        }
+        break;
+    case EV_TIMER:
+        if (!monitoring)
+            break;
+        if (booted)
+            sample_sensor();
+        // La prossima lettura arriva con il prossimo EV_TIMER: fino ad
+        // allora il bus è libero per l'accelerometro
+        i2cbus_reserve(I2CBUS_TSL2561, ev.timestamp + sample_period);
+        break;
+    }
+    return 1;
+}
+
+// Ogni consumatore legge dal proprio cursore e lavora al proprio ritmo:
+// uno lento perde campioni (contati nel menu 7), non rallenta gli altri
+int consume_samples(void) {
+    int busy = 0;
+
+    busy |= datalog_poll();
+    busy |= capture_poll();
+    busy |= stream_poll();
+    busy |= update_display();
+    return busy;
+}
+
+// Segnalazioni dei campioni a interrupt e solo a seriale libera: con il
+// bus I2C guasto l'errore si ripete a ogni periodo e una scrittura
+// bloccante (40 ms a 9600 baud) fermerebbe il main loop ogni volta
+static void sample_notice(const char *message) {
+    if (!stream_active() && !UART4_TxBusy())
+        UART4_StartTx(message, strlen(message));
+}
+
+// Legge il sensore e pubblica il campione nel ring
+void sample_sensor(void) {
+    uint16_t ch0, ch1;
+    unsigned int now = millis();
+
+    if (TSL2561_read_channels(&ch0, &ch1) != DRV_OK) {
+        // Campione perso, l'errore è contato nelle statistiche I2C
+        sample_notice("Errore I2C nella lettura del sensore.\r\n");
+        return;
+    }
+    sample_t s = { now, ch0, ch1, 0, TSL2561_GAIN, 0 };
+    s.lux = TSL2561_calc_lux(ch0, ch1);
+    if (TSL2561_SATURATED(ch0, ch1)) {
+        s.flags |= SAMPLE_SATURATED;
+        sample_notice("Sensore saturato o errore nella lettura.\r\n");
+    }
+    last_lux = s.lux;
+    samples_publish(&s);
+}
+
+// LED a ogni campione nuovo, LCD al massimo ogni lcd_ms; entrambi
+// mostrano solo il campione più recente
+int update_display(void) {
+    const sample_t *s;
+    int busy = 0;
+
+    if (!monitoring)
+        return 0;
+    if ((s = samples_latest(&led_reader))) {
+        update_leds(s->lux);
+        busy = 1;
+    }
+    if (!samples_pending(&lcd_reader) || millis() - lcd_time < settings_get(SETTING_LCD_MS))
+        return busy;
+    s = samples_latest(&lcd_reader);
+    lcd_time = millis();
+
+    // Lux, sparkline e barra: solo celle e glifi cambiati, si ferma al
+    // primo timeout per non accumulare attese
+    lcdgfx_frame(s->lux, settings_get(SETTING_MAX_LUX));
+    return 1;
+}
+
+// Salva l'ultimo valore di lux nelle impostazioni (un record da 8 byte,
+// nessuna cancellazione di settore a ogni detezione)
+void save_last_detection(void) {
+    char debug_buffer[50];
+    snprintf(debug_buffer, sizeof(debug_buffer), "Interrupt Triggered. Last lux: %d\r\n", last_lux);
+    UART4_WriteString(debug_buffer);  
+    
+    if (settings_set(SETTING_LAST_LUX, last_lux > 0xFFFF ? 0xFFFF : last_lux) != DRV_OK)
+        UART4_WriteString("Errore nella scrittura della flash.\r\n");
+}
+
+//Inizializzazione hardware: solo le periferiche immediate, LCD e sensore
+//proseguono in boot_poll() senza bloccare il menu
+void init_hardware() {
+    MultiVector_mode();
+    _nop();
+    Timer2_init();
+    Timer1_init(); // Tick di sistema da 1ms (debounce, timestamp eventi)
+    Init_pins();
+    BTNC_Interrupt_Init();
+    initSPI1(); // Inizializza SPI per Flash (nessuna cancellazione all'avvio)
+    settings_init(); // Prima di UART e sensore, che usano le impostazioni
+    UART4_set_baud(settings_get(SETTING_UART_BAUD));
+    TSL2561_set_timing(settings_get(SETTING_TSL_TIMING));
+    UART_ConfigurePins();
+    UART_ConfigureUart();
+    UART4_EnableRxInterrupt();
+    audio_init(); 
+    init_ADC();
+    i2c_master_setup();
+    
+    
+    // LED RGB Verde all'accensione
+    LED_RGB_RED = 0;
+    LED_RGB_GREEN = 1;
+    LED_RGB_BLUE = 0;
+}
+
+
+// Menu iniziale su UART, trasmesso a interrupt: il main loop (e con lui
+// l'avvio differito di LCD, sensore e log) prosegue durante i ~450 ms
+// di trasmissione a 9600 baud
+static const char menu_text[] =
+    "Menu:\r\n"
+    "1. Avvia monitoraggio luce ambientale\r\n"
+    "2. Visualizza ultima detezione luminosa\r\n"
+    "3. Reset ultima detezione\r\n"
+    "4. Statistiche log campioni\r\n"
+    "5. Monitoraggio con streaming telemetria\r\n"
+    "6. Cambia modalità clock\r\n"
+    "7. Diagnostica driver\r\n"
+    "8. Cattura con trigger\r\n"
+    "9. Visualizza ultima cattura\r\n"
+    "10. Memoria e margine dello stack\r\n"
+    "11. Impostazioni (set <nome> <valore>)\r\n"
+    "12. Analisi flicker (AN2)\r\n";
+
+void init_menu(void) {
+    UART4_StartTx(menu_text, sizeof(menu_text) - 1);
+    command_length = 0;
+}
+
+// Accumula i caratteri ricevuti fino a fine riga, poi esegue il comando
+void menu_handle_char(char c) {
+    if (c == '\n' || c == '\r') {
+        if (command_length == 0)
+            return; // Riga vuota (es. \n dopo \r)
+        uart_command[command_length] = '\0';
+        command_length = 0;
+        execute_command();
+    } else if (command_length < MAX_COMMAND_LENGTH - 1) {
+        uart_command[command_length++] = c;
+    }
+}
+
+void execute_command(void) {
+    if (strcmp(uart_command, "1") == 0) {
+        start_monitoring();
+    } else if (strcmp(uart_command, "2") == 0){
+        display_last_detection();
+        init_menu();
+    } else if (strcmp(uart_command, "3") == 0) {
+        reset_last_detection();
+        init_menu();
+    } else if (strcmp(uart_command, "4") == 0) {
+        datalog_report();
+        init_menu();
+    } else if (strcmp(uart_command, "5") == 0) {
+        stream_start();
+        start_monitoring();
+    } else if (strcmp(uart_command, "6") == 0) {
+        // basso consumo -> normale -> prestazioni -> basso consumo
+        if (clock_set_mode((clock_mode() + 1) % CLOCK_NUM_MODES) != DRV_OK)
+            UART4_WriteString("Cambio di clock fallito: oscillatore non pronto.\r\n");
+        clock_report();
+        init_menu();
+    } else if (strcmp(uart_command, "7") == 0) {
+        drv_report();
+        samples_report();
+        lcdgfx_report();
+        flash_geometry_report(&flash_geo);
+        flashcache_report();
+        i2cbus_report();
+        accel_report();
+        init_menu();
+    } else if (strcmp(uart_command, "8") == 0) {
+        capture_start();
+        start_monitoring();
+    } else if (strcmp(uart_command, "9") == 0) {
+        capture_dump_last();
+        init_menu();
+    } else if (strcmp(uart_command, "10") == 0) {
+        mem_report();
+        init_menu();
+    } else if (strcmp(uart_command, "11") == 0) {
+        settings_report();
+        init_menu();
+    } else if (strcmp(uart_command, "12") == 0) {
+        flicker_start();
+    } else if (strncmp(uart_command, "set ", 4) == 0) {
+        execute_set(&uart_command[4]);
+        init_menu();
+    } else {
+        UART4_WriteString("Errore: comando non valido\r\n");
+        init_menu();
+    }
+}
+
+// "set <nome> <valore>": valore decimale o esadecimale (0x..)
+void execute_set(char *args) {
+    char *value = strchr(args, ' ');
+    char *end;
+
+    if (value == NULL) {
+        UART4_WriteString("Uso: set <nome> <valore>\r\n");
+        return;
+    }
+    *value++ = '\0';
+    int key = settings_find(args);
+    unsigned long v = strtoul(value, &end, 0);
+    if (key < 0) {
+        UART4_WriteString("Errore: impostazione sconosciuta (menu 11)\r\n");
+        return;
+    }
+    if (end == value || *end != '\0') {
+        UART4_WriteString("Errore: valore non numerico\r\n");
+        return;
+    }
+    int status = settings_set(key, v);
+    if (status == DRV_INVALID)
+        UART4_WriteString("Errore: valore fuori dai limiti\r\n");
+    else if (status != DRV_OK)
+        UART4_WriteString("Errore nella scrittura della flash.\r\n");
+    else if (key == SETTING_UART_BAUD || key == SETTING_TSL_TIMING)
+        UART4_WriteString("Salvato, attivo dal prossimo avvio.\r\n");
+    else
+        UART4_WriteString("Salvato.\r\n");
+}
+
+// Funzione 1: Avvio monitoraggio
+void start_monitoring(void) {
+    monitoring = 1;
+    samples_attach(&led_reader, "LED");
+    samples_attach(&lcd_reader, "LCD");
+    lcdgfx_reset();
+    lcd_time = millis() - settings_get(SETTING_LCD_MS);
+    beep(); // Beep iniziale
+    LED_RGB_GREEN = 0;
+    LED_RGB_BLUE = 1;
+    // In streaming e in cattura si campiona alla velocità del sensore
+    sample_period = stream_active() || capture_active() ? TSL2561_INTEG_MS : settings_get(SETTING_SAMPLE_MS);
+    Timer1_set_event_period(sample_period);
+    i2cbus_reserve(I2CBUS_TSL2561, millis() + sample_period);
+    accel_start();
+}
+
+// Interrompe il monitoraggio e torna al menu
+void stop_monitoring(void) {
+    monitoring = 0;
+    Timer1_set_event_period(0);
+    accel_stop();
+    i2cbus_release();
+    LED_RGB_BLUE = 0;
+    LED_RGB_GREEN = 1;
+    init_menu();
+}
+
+// Funzione 2: Visualizza ultima detezione
+void display_last_detection(void) {
+    // Dall'indice in RAM delle impostazioni, nessuna lettura della flash
+    if (!settings_stored(SETTING_LAST_LUX)) {
+        UART4_WriteString("Nessuna detezione salvata.\r\n");
+        return;
+    }
+    int stored_lux = (int)settings_get(SETTING_LAST_LUX);
+    
+    // Prepara il messaggio da visualizzare
+    char buffer[50];
+    sprintf(buffer, "Last Light: %d LUX\r\n", stored_lux);
+
+    // Invia il messaggio tramite UART
+    UART4_WriteString(buffer);
+}
+
+// Funzione 3: Reset ultima detezione
+void reset_last_detection(void) {
+    if (settings_clear(SETTING_LAST_LUX) == DRV_OK)
+        UART4_WriteString("Ultima detezione resettata.\r\n");
+    else
+        UART4_WriteString("Errore nella scrittura della flash.\r\n");
+}
+
+// Funzione per aggiornare i LED in base al valore di Lux
+void update_leds(int lux) {
+    // Calcola il numero di LED da accendere in base al valore di lux
+    int num_leds = NUM_LEDS - (lux * NUM_LEDS) / (int)settings_get(SETTING_MAX_LUX);
+
+    // Aggiorna i LED
+    unsigned char pattern = 0x00;
+    for (int i = 0; i < num_leds; i++) {
+        pattern |= (1 << i);  // Accende il LED corrispondente
+    }
+
+    // Imposta il pattern sui LED (porta A)
+    LATA = (LATA & 0xFF00) | pattern;
+}
+
+// Beep a 10kHz, 50% duty: si spegne da beep_poll() dopo BEEP_MS, senza
+// fermare il main loop
+void beep(){ 
+    OC1CONbits.ON = 1;            // Accende OC1     
+    beep_time = millis();
+    beeping = 1;
+}
+
+int beep_poll(void) {
+    if (!beeping || millis() - beep_time < BEEP_MS)
+        return 0;
+    OC1CONbits.ON = 0;
+    beeping = 0;
+    return 1;
+}
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Occupazione della RAM statica dal map file del linker XC32.
+
+Uso: python3 ramreport.py dist/default/production/Prog15.X.production.map
+
+Somma le sezioni di input allocate nella RAM (kseg0/kseg1_data_mem) per
+file oggetto e per tipo (.data/.sdata inizializzate, .bss/.sbss azzerate),
+elenca i simboli globali più grandi e il margine rimasto per heap e stack.
+Le variabili static non compaiono nel map: sono conteggiate nel totale
+del file ma non tra i simboli.
+"""
+
+import os
+import re
+import sys
+
+RAM_REGIONS = ("kseg1_data_mem", "kseg0_data_mem")
+TOP_SYMBOLS = 15
+
+SECTION_RE = re.compile(r"^(\.\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s*$")
+INPUT_RE = re.compile(r"^ (\.\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+SYMBOL_RE = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+([A-Za-z_]\w*)\s*$")
+REGION_RE = re.compile(r"^(\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+
+
+def kind(section):
+    if section.startswith((".bss", ".sbss")):
+        return "bss"
+    if section.startswith((".data", ".sdata", ".lit", ".ramfunc")):
+        return "data"
+    if section.startswith(".heap"):
+        return "heap"
+    if section.startswith(".stack"):
+        return "stack"
+    return "altro"
+
+
+def parse(path):
+    with open(path, errors="replace") as f:
+        lines = f.read().splitlines()
+
+    # Memory Configuration: nome, origine, lunghezza (il nome può stare
+    # su una riga a sé se troppo lungo)
+    regions = {}
+    i = lines.index("Memory Configuration") if "Memory Configuration" in lines else 0
+    pending = None
+    for line in lines[i + 1:]:
+        if line.startswith("Linker script and memory map"):
+            break
+        m = REGION_RE.match(line)
+        if m:
+            name = m.group(1) or pending
+            if name in RAM_REGIONS:
+                regions[name] = (int(m.group(2), 16), int(m.group(3), 16))
+            pending = None
+        elif line.strip() and " " not in line.strip():
+            pending = line.strip()
+
+    def in_ram(addr):
+        return any(o <= addr < o + l for o, l in regions.values())
+
+    inputs = []    # (sezione, indirizzo, dimensione, file)
+    symbols = []   # (indirizzo, nome)
+    output = None
+    wrapped = None
+    for line in lines:
+        m = SECTION_RE.match(line)
+        if m:
+            output = m.group(1)
+            continue
+        if line.startswith(" .") and len(line.split()) == 1:
+            wrapped = line.strip()  # nome lungo, dati sulla riga seguente
+            continue
+        m = INPUT_RE.match(line)
+        if m and output:
+            section = m.group(1) or wrapped or output
+            addr, size = int(m.group(2), 16), int(m.group(3), 16)
+            wrapped = None
+            if size and in_ram(addr):
+                inputs.append((section, addr, size, os.path.basename(m.group(4).strip())))
+            continue
+        m = SYMBOL_RE.match(line)
+        if m:
+            symbols.append((int(m.group(1), 16), m.group(2)))
+    return regions, inputs, symbols
+
+
+def report(path):
+    regions, inputs, symbols = parse(path)
+    if not regions:
+        sys.exit("%s: nessuna regione RAM nel map file" % path)
+
+    per_file = {}
+    totals = {}
+    for section, addr, size, obj in inputs:
+        k = kind(section)
+        totals[k] = totals.get(k, 0) + size
+        if k in ("data", "bss"):
+            per_file.setdefault(obj, {"data": 0, "bss": 0})[k] += size
+
+    # Dimensione dei simboli: distanza dal simbolo successivo nella stessa
+    # sezione di input
+    sized = []
+    for section, addr, size, obj in inputs:
+        if kind(section) not in ("data", "bss"):
+            continue
+        inside = sorted(s for s in symbols if addr <= s[0] < addr + size)
+        for j, (a, name) in enumerate(inside):
+            end = inside[j + 1][0] if j + 1 < len(inside) else addr + size
+            sized.append((end - a, name, obj))
+
+    ram = sum(l for o, l in regions.values())
+    static = totals.get("data", 0) + totals.get("bss", 0)
+
+    print("RAM statica per file oggetto (byte)")
+    print("  %-24s %8s %8s %8s" % ("file", "data", "bss", "totale"))
+    for obj, v in sorted(per_file.items(), key=lambda kv: -(kv[1]["data"] + kv[1]["bss"])):
+        print("  %-24s %8d %8d %8d" % (obj, v["data"], v["bss"], v["data"] + v["bss"]))
+    print()
+    print("Simboli globali più grandi")
+    for size, name, obj in sorted(sized, reverse=True)[:TOP_SYMBOLS]:
+        print("  %8d  %-28s %s" % (size, name, obj))
+    print()
+    print("RAM totale:     %8d" % ram)
+    print("Statica:        %8d (%.1f%%)" % (static, 100.0 * static / ram))
+    for k in ("heap", "stack", "altro"):
+        if totals.get(k):
+            print("%-15s %8d" % (k.capitalize() + ":", totals[k]))
+    print("Libera:         %8d (stack oltre il minimo riservato)"
+          % (ram - static - sum(totals.get(k, 0) for k in ("heap", "stack", "altro"))))
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    report(sys.argv[1])
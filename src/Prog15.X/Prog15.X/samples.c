@@ -0,0 +1,97 @@
+/*
+ * File:   samples.c
+ *
+ * Le sequenze sono contatori a 32 bit liberi di andare in overflow: la
+ * posizione nel ring è seq & SAMPLES_MASK e l'età di un campione è
+ * head - seq in aritmetica senza segno. Scrittore e lettori girano tutti
+ * nel main loop, quindi non servono sezioni critiche.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include "samples.h"
+#include "Uart.h"
+
+#define SAMPLES_MASK (SAMPLES_SIZE - 1)
+
+static sample_t ring[SAMPLES_SIZE];
+static uint32_t head = 0;
+
+static sample_reader_t *readers[SAMPLES_MAX_READERS];
+static int num_readers = 0;
+
+uint32_t samples_publish(const sample_t *s) {
+    ring[head & SAMPLES_MASK] = *s;
+    return head++;
+}
+
+uint32_t samples_head(void) {
+    return head;
+}
+
+const sample_t *samples_at(uint32_t seq) {
+    if (head - seq - 1 >= SAMPLES_SIZE)
+        return NULL;
+    return &ring[seq & SAMPLES_MASK];
+}
+
+void samples_attach(sample_reader_t *r, const char *name) {
+    int i;
+
+    for (i = 0; i < num_readers && readers[i] != r; i++)
+        ;
+    if (i == num_readers && num_readers < SAMPLES_MAX_READERS)
+        readers[num_readers++] = r;
+    r->name = name;
+    r->next = head;
+    r->read = 0;
+    r->overruns = 0;
+    r->lost = 0;
+}
+
+const sample_t *samples_peek(sample_reader_t *r) {
+    uint32_t behind = head - r->next;
+
+    if (behind == 0)
+        return NULL;
+    if (behind > SAMPLES_SIZE) {
+        // Superato dallo scrittore: riparte dal più vecchio disponibile
+        r->overruns++;
+        r->lost += behind - SAMPLES_SIZE;
+        r->next = head - SAMPLES_SIZE;
+    }
+    return &ring[r->next & SAMPLES_MASK];
+}
+
+void samples_advance(sample_reader_t *r) {
+    if (r->next != head) {
+        r->next++;
+        r->read++;
+    }
+}
+
+const sample_t *samples_latest(sample_reader_t *r) {
+    if (r->next == head)
+        return NULL;
+    r->next = head;
+    r->read++;
+    return &ring[(head - 1) & SAMPLES_MASK];
+}
+
+unsigned int samples_pending(const sample_reader_t *r) {
+    return head - r->next;
+}
+
+void samples_report(void) {
+    char buffer[80];
+
+    snprintf(buffer, sizeof(buffer), "Campioni pubblicati: %lu (ring da %d)\r\n",
+             (unsigned long)head, SAMPLES_SIZE);
+    UART4_WriteString(buffer);
+    for (int i = 0; i < num_readers; i++) {
+        snprintf(buffer, sizeof(buffer), "%s: letti %u, in attesa %u, superato %u volte, persi %u\r\n",
+                 readers[i]->name, readers[i]->read, samples_pending(readers[i]),
+                 readers[i]->overruns, readers[i]->lost);
+        UART4_WriteString(buffer);
+    }
+}
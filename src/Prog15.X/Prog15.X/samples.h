@@ -0,0 +1,73 @@
+/*
+ * File:   samples.h
+ *
+ * Ring dei campioni con un solo scrittore (l'acquisizione nel main loop) e
+ * più lettori: LED, LCD, log in flash, streaming e cattura hanno ciascuno
+ * il proprio cursore e consumano al proprio ritmo. Il lettore riceve un
+ * puntatore al campione nel ring, senza copie; il puntatore resta valido
+ * fino alla pubblicazione successiva. Un lettore lento non rallenta mai
+ * l'acquisizione: se viene superato dallo scrittore salta al campione più
+ * vecchio ancora presente e i campioni persi vengono contati.
+ */
+
+#ifndef SAMPLES_H
+#define SAMPLES_H
+
+#include <stdint.h>
+
+// Dimensione del ring, potenza di 2. Deve contenere anche la finestra di
+// una cattura (capture.h), che viene letta direttamente da qui
+#define SAMPLES_SIZE        128
+#define SAMPLES_MAX_READERS 8
+
+// Flag del campione
+#define SAMPLE_SATURATED    0x01
+
+typedef struct {
+    uint32_t time;      // ms dall'avvio
+    uint16_t ch0;
+    uint16_t ch1;
+    uint16_t lux;
+    uint8_t gain;
+    uint8_t flags;
+} sample_t;
+
+typedef struct {
+    const char *name;
+    uint32_t next;          // sequenza del prossimo campione da leggere
+    unsigned int read;
+    unsigned int overruns;  // volte in cui il lettore è stato superato
+    unsigned int lost;      // campioni sovrascritti prima della lettura
+} sample_reader_t;
+
+// Pubblica un campione, ritorna il suo numero di sequenza
+uint32_t samples_publish(const sample_t *s);
+
+// Sequenza del prossimo campione che verrà pubblicato
+uint32_t samples_head(void);
+
+// Campione con la sequenza indicata, NULL se già sovrascritto o non ancora
+// pubblicato
+const sample_t *samples_at(uint32_t seq);
+
+// Registra il lettore (una sola volta) e lo posiziona sul prossimo campione
+// pubblicato, azzerando i contatori
+void samples_attach(sample_reader_t *r, const char *name);
+
+// Prossimo campione non letto senza consumarlo, NULL se non ce ne sono
+const sample_t *samples_peek(sample_reader_t *r);
+
+// Consuma il campione restituito da samples_peek()
+void samples_advance(sample_reader_t *r);
+
+// Campione più recente, segna come letti anche quelli intermedi (saltati
+// di proposito, non contati come persi). NULL se non ce ne sono di nuovi
+const sample_t *samples_latest(sample_reader_t *r);
+
+// Campioni pubblicati e non ancora letti
+unsigned int samples_pending(const sample_reader_t *r);
+
+// Stampa su UART i contatori di ogni lettore
+void samples_report(void);
+
+#endif // SAMPLES_H
@@ -0,0 +1,291 @@
+/*
+ * File:   settings.c
+ *
+ * Store delle impostazioni a log con rotazione dei settori.
+ * Sicurezza in caso di mancanza di alimentazione:
+ *  - un record scritto a metà ha CRC errato e viene ignorato: la chiave
+ *    mantiene il valore precedente;
+ *  - la compattazione scrive in un settore diverso da quello attivo e
+ *    scrive l'header per ultimo: finché l'header non è valido all'avvio
+ *    resta attivo il settore vecchio, che non viene mai cancellato qui.
+ * Usura: un settore viene cancellato solo quando la scrittura arriva a
+ * lui dopo aver fatto il giro di tutta la regione, cioè ogni circa
+ * SETTINGS_SECTORS * (SETTINGS_SLOTS - 1) modifiche.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "settings.h"
+#include "spi.h"
+#include "Uart.h"
+#include "TSL2561.h"
+#include "drv.h"
+
+#define SETTINGS_SECTORS    ((SETTINGS_END_ADDR - SETTINGS_START_ADDR) / FLASH_SECTOR_SIZE)
+#define SETTINGS_SLOTS      (FLASH_SECTOR_SIZE / SETTINGS_RECORD_SIZE)
+#define SLOTS_PER_PAGE      (FLASH_PAGE_SIZE / SETTINGS_RECORD_SIZE)
+
+#if SETTINGS_SECTORS < 2
+#error "servono almeno due settori per la compattazione"
+#endif
+
+static const struct {
+    const char *name;
+    uint32_t def;
+    uint32_t min;
+    uint32_t max;
+} table[SETTINGS_NUM_KEYS] = {
+    [SETTING_MAX_LUX]    = { "max_lux", 1800, 100, 40000 },
+    [SETTING_SAMPLE_MS]  = { "sample_ms", 1000, 200, 60000 },
+    [SETTING_LCD_MS]     = { "lcd_ms", 250, 0, 10000 },
+    [SETTING_TSL_TIMING] = { "tsl_timing", TSL2561_TIMING_DEFAULT, 0x00, 0x12 },
+    [SETTING_UART_BAUD]  = { "baud", UART_BAUD, 9600, 38400 },
+    [SETTING_LAST_LUX]   = { "last_lux", 0, 0, 65535 },
+};
+
+// Indice in RAM
+static uint32_t values[SETTINGS_NUM_KEYS];
+static uint8_t stored[SETTINGS_NUM_KEYS];
+
+// Settore attivo (-1: regione vuota) e primo slot libero
+static int active = -1;
+static uint32_t generation = 0;
+static int next_slot = SETTINGS_SLOTS;
+static int dirty = 0;   // record corrotti nel settore attivo: compattare
+
+static unsigned int corrupt_records = 0;
+static unsigned int compactions = 0;
+static unsigned int write_errors = 0;
+
+// CRC-16 CCITT (polinomio 0x1021, valore iniziale 0xFFFF)
+static uint16_t crc16(const uint8_t *p, int len) {
+    uint16_t crc = 0xFFFF;
+
+    while (len--) {
+        crc ^= (uint16_t)*p++ << 8;
+        for (int i = 0; i < 8; i++)
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Record o header: 6 byte di contenuto e CRC
+static void encode(uint8_t *r, uint8_t b0, uint8_t b1, uint32_t v) {
+    r[0] = b0;
+    r[1] = b1;
+    r[2] = v & 0xFF;
+    r[3] = (v >> 8) & 0xFF;
+    r[4] = (v >> 16) & 0xFF;
+    r[5] = v >> 24;
+    uint16_t crc = crc16(r, 6);
+    r[6] = crc & 0xFF;
+    r[7] = crc >> 8;
+}
+
+static int crc_ok(const uint8_t *r) {
+    return crc16(r, 6) == (r[6] | (r[7] << 8));
+}
+
+static int is_free(const uint8_t *r) {
+    for (int i = 0; i < SETTINGS_RECORD_SIZE; i++) {
+        if (r[i] != 0xFF)
+            return 0;
+    }
+    return 1;
+}
+
+static int sector_addr(int sector) {
+    return SETTINGS_START_ADDR + sector * FLASH_SECTOR_SIZE;
+}
+
+static int valid(int key, uint32_t value) {
+    if (key < 0 || key >= SETTINGS_NUM_KEYS || value < table[key].min || value > table[key].max)
+        return 0;
+    if (key == SETTING_TSL_TIMING)
+        return TSL2561_TIMING_VALID(value);
+    if (key == SETTING_UART_BAUD)
+        return UART_BAUD_VALID(value);
+    return 1;
+}
+
+static void apply(const uint8_t *r) {
+    int key = r[0];
+
+    if (key >= SETTINGS_NUM_KEYS)
+        return; // chiave di una versione successiva del firmware
+    if (r[1] == SETTINGS_TAG_VALUE && valid(key, get32(&r[2]))) {
+        values[key] = get32(&r[2]);
+        stored[key] = 1;
+    } else if (r[1] == SETTINGS_TAG_CLEARED) {
+        values[key] = table[key].def;
+        stored[key] = 0;
+    }
+}
+
+// Rilegge i record del settore attivo fino al primo slot libero
+static void load_active(void) {
+    uint8_t page[FLASH_PAGE_SIZE];
+    int addr = sector_addr(active);
+
+    next_slot = SETTINGS_SLOTS;
+    for (int slot = 1; slot < SETTINGS_SLOTS; slot++) {
+        int offset = (slot % SLOTS_PER_PAGE) * SETTINGS_RECORD_SIZE;
+        if (slot == 1 || offset == 0) {
+            if (readFlashBlock(addr + slot * SETTINGS_RECORD_SIZE, page + offset, FLASH_PAGE_SIZE - offset) != DRV_OK) {
+                dirty = 1; // meglio ricompattare che scrivere alla cieca
+                return;
+            }
+        }
+        const uint8_t *r = &page[offset];
+        if (is_free(r)) {
+            next_slot = slot;
+            return;
+        }
+        if (crc_ok(r)) {
+            apply(r);
+        } else {
+            corrupt_records++;
+            dirty = 1;
+        }
+    }
+}
+
+void settings_init(void) {
+    uint8_t h[SETTINGS_RECORD_SIZE];
+
+    for (int key = 0; key < SETTINGS_NUM_KEYS; key++) {
+        values[key] = table[key].def;
+        stored[key] = 0;
+    }
+    active = -1;
+    dirty = 0;
+
+    // Settore con l'header valido e la generazione più recente
+    for (int sector = 0; sector < SETTINGS_SECTORS; sector++) {
+        if (readFlashBlock(sector_addr(sector), h, sizeof(h)) != DRV_OK)
+            continue;
+        if (h[0] != SETTINGS_MAGIC || h[1] != SETTINGS_VERSION || !crc_ok(h))
+            continue;
+        uint32_t gen = get32(&h[2]);
+        if (active < 0 || (int32_t)(gen - generation) > 0) {
+            active = sector;
+            generation = gen;
+        }
+    }
+    if (active >= 0)
+        load_active();
+}
+
+uint32_t settings_get(int key) {
+    return values[key];
+}
+
+int settings_stored(int key) {
+    return stored[key];
+}
+
+// Ricopia i valori salvati (con la modifica già nell'indice) nel prossimo
+// settore della rotazione
+static int compact(void) {
+    uint8_t page[FLASH_PAGE_SIZE];
+    int target = (active + 1) % SETTINGS_SECTORS;
+    int addr = sector_addr(target);
+    int n = 0;
+
+    for (int key = 0; key < SETTINGS_NUM_KEYS; key++) {
+        if (stored[key])
+            encode(&page[SETTINGS_RECORD_SIZE * ++n], key, SETTINGS_TAG_VALUE, values[key]);
+    }
+    int status = EraseSector(addr);
+    if (status == DRV_OK && n)
+        status = writeFlashPage(addr + SETTINGS_RECORD_SIZE, &page[SETTINGS_RECORD_SIZE], n * SETTINGS_RECORD_SIZE);
+    if (status == DRV_OK) {
+        encode(page, SETTINGS_MAGIC, SETTINGS_VERSION, generation + 1);
+        status = writeFlashPage(addr, page, SETTINGS_RECORD_SIZE);
+    }
+    if (status != DRV_OK)
+        return status;
+
+    active = target;
+    generation++;
+    next_slot = n + 1;
+    dirty = 0;
+    compactions++;
+    return DRV_OK;
+}
+
+// Scrive un record; se il settore è pieno o ha record corrotti compatta
+static int append(int key, uint8_t tag, uint32_t value) {
+    uint32_t old_value = values[key];
+    uint8_t old_stored = stored[key];
+    uint8_t r[SETTINGS_RECORD_SIZE];
+    int status;
+
+    encode(r, key, tag, value);
+    if (active >= 0 && !dirty && next_slot < SETTINGS_SLOTS) {
+        status = writeFlashPage(sector_addr(active) + next_slot * SETTINGS_RECORD_SIZE, r, sizeof(r));
+        next_slot++; // anche se fallita, lo slot può essere parzialmente scritto
+        if (status == DRV_OK) {
+            apply(r);
+            return DRV_OK;
+        }
+        dirty = 1;
+    }
+
+    apply(r);
+    status = compact();
+    if (status != DRV_OK) {
+        values[key] = old_value;
+        stored[key] = old_stored;
+        write_errors++;
+    }
+    return status;
+}
+
+int settings_set(int key, uint32_t value) {
+    if (!valid(key, value))
+        return DRV_INVALID;
+    if (stored[key] && values[key] == value)
+        return DRV_OK; // nessuna scrittura per un valore invariato
+    return append(key, SETTINGS_TAG_VALUE, value);
+}
+
+int settings_clear(int key) {
+    if (key < 0 || key >= SETTINGS_NUM_KEYS)
+        return DRV_INVALID;
+    if (!stored[key])
+        return DRV_OK;
+    return append(key, SETTINGS_TAG_CLEARED, 0);
+}
+
+int settings_find(const char *name) {
+    for (int key = 0; key < SETTINGS_NUM_KEYS; key++) {
+        if (strcmp(table[key].name, name) == 0)
+            return key;
+    }
+    return -1;
+}
+
+void settings_report(void) {
+    char buffer[80];
+
+    for (int key = 0; key < SETTINGS_NUM_KEYS; key++) {
+        snprintf(buffer, sizeof(buffer), "%-11s %lu%s\r\n", table[key].name,
+                 (unsigned long)values[key], stored[key] ? "" : " (default)");
+        UART4_WriteString(buffer);
+    }
+    if (active < 0) {
+        UART4_WriteString("Impostazioni: nessun settore scritto\r\n");
+    } else {
+        snprintf(buffer, sizeof(buffer), "Settore %d/%d, generazione %lu, %d/%d record usati\r\n",
+                 active, SETTINGS_SECTORS, (unsigned long)generation, next_slot - 1, SETTINGS_SLOTS - 1);
+        UART4_WriteString(buffer);
+    }
+    snprintf(buffer, sizeof(buffer), "Compattazioni %u, record corrotti %u, errori di scrittura %u\r\n",
+             compactions, corrupt_records, write_errors);
+    UART4_WriteString(buffer);
+}
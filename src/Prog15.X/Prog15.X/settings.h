@@ -0,0 +1,57 @@
+/*
+ * File:   settings.h
+ *
+ * Impostazioni persistenti in flash (SETTINGS_START_ADDR..SETTINGS_END_ADDR).
+ * Ogni modifica aggiunge un record da 8 byte con CRC nel settore attivo;
+ * quando è pieno i valori correnti vengono ricopiati in un settore nuovo,
+ * a rotazione su tutta la regione, e solo alla fine ne viene scritto
+ * l'header. All'avvio un indice in RAM raccoglie l'ultimo valore di ogni
+ * chiave: dopo settings_init() le letture non accedono alla flash.
+ */
+
+#ifndef SETTINGS_H
+#define SETTINGS_H
+
+#include <stdint.h>
+
+// Chiavi: posizione nell'indice in RAM e nella tabella dei default
+#define SETTING_MAX_LUX     0   // lux per tutti i LED spenti (e LCD)
+#define SETTING_SAMPLE_MS   1   // periodo di campionamento del monitoraggio
+#define SETTING_LCD_MS      2   // aggiornamento massimo dell'LCD
+#define SETTING_TSL_TIMING  3   // registro di timing del TSL2561, dal prossimo avvio
+#define SETTING_UART_BAUD   4   // baud rate di UART4, dal prossimo avvio
+#define SETTING_LAST_LUX    5   // ultima detezione (BTNC)
+#define SETTINGS_NUM_KEYS   6
+
+// Record (little endian): chiave, tag, valore a 32 bit, CRC-16 dei primi 6
+// byte. Lo slot 0 di ogni settore è l'header: magic, versione,
+// generazione a 32 bit, CRC-16
+#define SETTINGS_RECORD_SIZE    8
+#define SETTINGS_MAGIC          0xC5
+#define SETTINGS_VERSION        1
+#define SETTINGS_TAG_VALUE      0x5A
+#define SETTINGS_TAG_CLEARED    0x00    // chiave riportata al default
+
+// Legge la regione e costruisce l'indice (da chiamare dopo initSPI1)
+void settings_init(void);
+
+// Valore corrente, o il default se la chiave non è mai stata scritta
+uint32_t settings_get(int key);
+
+// 1 se la chiave ha un valore salvato
+int settings_stored(int key);
+
+// Salva un valore: DRV_OK, DRV_INVALID se fuori dai limiti o un errore
+// della flash (l'indice non cambia)
+int settings_set(int key, uint32_t value);
+
+// Riporta la chiave al default
+int settings_clear(int key);
+
+// Chiave dal nome, -1 se sconosciuto
+int settings_find(const char *name);
+
+// Stampa su UART i valori e lo stato della regione
+void settings_report(void);
+
+#endif // SETTINGS_H
@@ -0,0 +1,182 @@
+/*
+ * File:   sfdp.c
+ *
+ * Parser del JEDEC ID e della Basic Flash Parameter Table (BFPT) SFDP.
+ * DWORD usate (numerate da 1 come in JESD216):
+ *  1   supporto e comando della cancellazione da 4KB, byte di indirizzo
+ *  2   densità
+ *  8-9 tipi di cancellazione: dimensione 2^N e comando
+ *  10  tempi tipici di cancellazione e moltiplicatore del massimo (JESD216A)
+ *  11  dimensione della pagina, tempi di programmazione e chip erase
+ */
+
+#include <stdio.h>
+#include "sfdp.h"
+#include "spi.h"
+#include "Uart.h"
+#include "drv.h"
+
+// Parti senza SFDP con geometria diversa dai valori di default
+static const struct {
+    uint32_t id;
+    uint16_t page_size;
+    uint8_t erase_opcode;
+    uint32_t erase_size;
+    uint32_t erase_timeout_ms;
+    uint8_t aai;
+} known_parts[] = {
+    { 0xBF2541, 1, 0x20, 4096, 25, 1 },     // SST25VF016B: a byte o AAI a parole
+    { 0x202016, 256, 0xD8, 65536, 3000, 0 }, // M25P32: solo settori da 64KB
+};
+
+#define NUM_KNOWN_PARTS (sizeof(known_parts) / sizeof(known_parts[0]))
+
+static uint32_t dword(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Tempo tipico di cancellazione (DWORD 10): conteggio a 5 bit + unità
+static uint32_t erase_time_ms(uint32_t count, uint32_t units) {
+    static const uint16_t unit_ms[] = { 1, 16, 128, 1000 };
+    return (count + 1) * unit_ms[units & 3];
+}
+
+static void set_defaults(flash_geometry_t *g, uint32_t id) {
+    uint32_t capacity = JEDEC_CAPACITY(id);
+
+    g->jedec_id = id;
+    g->size = capacity >= 0x10 && capacity <= 0x18 ? 1UL << capacity : 0;
+    g->page_size = FLASH_PAGE_SIZE;
+    g->sfdp = 0;
+    g->aai = 0;
+    g->locked = 0;
+    g->erase_opcode = 0x20;
+    g->erase_size = FLASH_SECTOR_SIZE;
+    g->erase_typ_ms = 0;
+    g->erase_timeout_ms = FLASH_SECTOR_ERASE_TIMEOUT_MS;
+    g->program_typ_us = 0;
+    g->program_timeout_ms = FLASH_PROGRAM_TIMEOUT_MS;
+    g->chip_erase_timeout_ms = FLASH_CHIP_ERASE_TIMEOUT_MS;
+
+    for (unsigned int i = 0; i < NUM_KNOWN_PARTS; i++) {
+        if (known_parts[i].id == id) {
+            g->page_size = known_parts[i].page_size;
+            g->erase_opcode = known_parts[i].erase_opcode;
+            g->erase_size = known_parts[i].erase_size;
+            g->erase_timeout_ms = known_parts[i].erase_timeout_ms;
+            g->aai = known_parts[i].aai;
+        }
+    }
+}
+
+static void parse_bfpt(flash_geometry_t *g, const uint32_t *dw, int n) {
+    int erase_type = -1;
+
+    // DWORD 2: densità in bit
+    if (dw[1] & 0x80000000) {
+        if ((dw[1] & 0x7FFFFFFF) - 3 < 32)
+            g->size = 1UL << ((dw[1] & 0x7FFFFFFF) - 3);
+    } else {
+        g->size = (dw[1] + 1) / 8;
+    }
+
+    // DWORD 1: cancellazione da 4KB
+    if ((dw[0] & 0x03) == 0x01) {
+        g->erase_opcode = (dw[0] >> 8) & 0xFF;
+        g->erase_size = 4096;
+    }
+
+    // DWORD 8-9: il tipo di cancellazione più piccolo
+    if (n >= 9) {
+        uint32_t smallest = 0;
+        for (int t = 0; t < 4; t++) {
+            uint32_t field = (dw[7 + t / 2] >> (16 * (t % 2))) & 0xFFFF;
+            uint32_t exponent = field & 0xFF;
+            if (exponent == 0 || exponent >= 32)
+                continue; // tipo non presente
+            if (!smallest || (1UL << exponent) < smallest) {
+                smallest = 1UL << exponent;
+                erase_type = t;
+                g->erase_size = smallest;
+                g->erase_opcode = field >> 8;
+            }
+        }
+    }
+
+    // DWORD 10: tempi di cancellazione, massimo = 2 * (M + 1) * tipico
+    if (n >= 10 && erase_type >= 0) {
+        uint32_t multiplier = 2 * ((dw[9] & 0x0F) + 1);
+        uint32_t field = dw[9] >> (4 + 7 * erase_type);
+        uint32_t typ = erase_time_ms(field & 0x1F, (field >> 5) & 0x03);
+        g->erase_typ_ms = typ;
+        g->erase_timeout_ms = typ * multiplier;
+    }
+
+    // DWORD 11: pagina, programmazione e chip erase
+    if (n >= 11) {
+        static const uint32_t chip_unit_ms[] = { 16, 256, 4000, 64000 };
+        uint32_t multiplier = 2 * ((dw[10] & 0x0F) + 1);
+        uint32_t erase_multiplier = 2 * ((dw[9] & 0x0F) + 1);
+        uint32_t typ_us = (((dw[10] >> 8) & 0x1F) + 1) * ((dw[10] & 0x2000) ? 64 : 8);
+
+        g->page_size = 1 << ((dw[10] >> 4) & 0x0F);
+        g->program_typ_us = typ_us;
+        g->program_timeout_ms = (typ_us * multiplier + 999) / 1000;
+        g->chip_erase_timeout_ms = (((dw[10] >> 24) & 0x1F) + 1)
+                                   * chip_unit_ms[(dw[10] >> 29) & 0x03] * erase_multiplier;
+    }
+}
+
+int sfdp_detect(flash_geometry_t *g, uint32_t jedec_id, sfdp_read_t read) {
+    uint8_t buf[8];
+    uint32_t dw[SFDP_BFPT_MAX_DWORDS];
+    uint8_t raw[4];
+
+    set_defaults(g, jedec_id);
+    if (jedec_id == 0 || jedec_id == 0xFFFFFF)
+        return DRV_NACK; // MISO fisso: nessuna flash collegata
+
+    // Header SFDP: firma, revisione, numero di parameter header - 1
+    if (read(0, buf, 8) != DRV_OK || dword(buf) != SFDP_SIGNATURE)
+        return DRV_OK;
+    int headers = buf[6] + 1;
+
+    for (int i = 0; i < headers; i++) {
+        if (read(8 + 8 * i, buf, 8) != DRV_OK)
+            return DRV_OK;
+        // ID 0xFF00: tabella di base JEDEC
+        if (buf[0] != 0x00 || buf[7] != 0xFF)
+            continue;
+        int n = buf[3] < SFDP_BFPT_MAX_DWORDS ? buf[3] : SFDP_BFPT_MAX_DWORDS;
+        uint32_t table = buf[4] | (buf[5] << 8) | ((uint32_t)buf[6] << 16);
+        if (n < 2)
+            return DRV_OK;
+        for (int d = 0; d < n; d++) {
+            if (read(table + 4 * d, raw, 4) != DRV_OK)
+                return DRV_OK;
+            dw[d] = dword(raw);
+        }
+        parse_bfpt(g, dw, n);
+        g->sfdp = 1;
+        return DRV_OK;
+    }
+    return DRV_OK;
+}
+
+void flash_geometry_report(const flash_geometry_t *g) {
+    char buffer[96];
+
+    snprintf(buffer, sizeof(buffer), "Flash: JEDEC ID %06lX, %lu KB, %s\r\n",
+             (unsigned long)g->jedec_id, (unsigned long)(g->size / 1024),
+             g->sfdp ? "parametri SFDP" : "parametri di default");
+    UART4_WriteString(buffer);
+    snprintf(buffer, sizeof(buffer), "Pagina %u byte%s, cancellazione %lu KB (0x%02X), lettura 0x%02X\r\n",
+             g->page_size, g->aai ? " (AAI)" : "", (unsigned long)(g->erase_size / 1024), g->erase_opcode,
+             FLASH_CMD_READ);
+    UART4_WriteString(buffer);
+    if (g->locked)
+        UART4_WriteString("Flash protetta in scrittura: bit BP bloccati dal pin WP#\r\n");
+    snprintf(buffer, sizeof(buffer), "Timeout: cancellazione %lu ms, programmazione %u ms, chip %lu ms\r\n",
+             (unsigned long)g->erase_timeout_ms, g->program_timeout_ms, (unsigned long)g->chip_erase_timeout_ms);
+    UART4_WriteString(buffer);
+}
@@ -0,0 +1,52 @@
+/*
+ * File:   sfdp.h
+ *
+ * Riconoscimento della flash seriale: JEDEC ID (0x9F) e tabella dei
+ * parametri di base SFDP (JESD216, comando 0x5A). Da qui il driver in
+ * spi.c prende dimensione della pagina, cancellazione più piccola
+ * disponibile, comando di lettura e tempi massimi delle operazioni.
+ * Non accede all'hardware: la lettura dello spazio SFDP è passata come
+ * funzione, così il parser gira anche nel replay su host.
+ */
+
+#ifndef SFDP_H
+#define SFDP_H
+
+#include <stdint.h>
+
+// JEDEC ID: produttore, tipo di memoria, capacità (2^N byte)
+#define JEDEC_MANUFACTURER(id)  (((id) >> 16) & 0xFF)
+#define JEDEC_CAPACITY(id)      ((id) & 0xFF)
+#define JEDEC_SST               0xBF
+
+#define SFDP_SIGNATURE          0x50444653 // "SFDP", little endian
+#define SFDP_BFPT_MAX_DWORDS    16
+
+typedef struct {
+    uint32_t jedec_id;
+    uint32_t size;              // byte
+    uint16_t page_size;         // limite di una programmazione
+    uint8_t sfdp;               // 1 se i parametri vengono da SFDP
+    uint8_t aai;                // programmazione AAI a parole (0xAD), SST25
+    uint8_t locked;             // bit BP che non si azzerano (pin WP#)
+    uint8_t erase_opcode;       // cancellazione più piccola disponibile
+    uint32_t erase_size;
+    uint16_t erase_typ_ms;
+    uint32_t erase_timeout_ms;
+    uint16_t program_typ_us;
+    uint16_t program_timeout_ms;
+    uint32_t chip_erase_timeout_ms;
+} flash_geometry_t;
+
+// Legge len byte dallo spazio SFDP, ritorna DRV_OK o un codice di errore
+typedef int (*sfdp_read_t)(uint32_t addr, uint8_t *buf, int len);
+
+// Ricava la geometria dal JEDEC ID e, se presenti, dalle tabelle SFDP.
+// Senza SFDP usa una tabella di parti note o i valori prudenti di spi.h.
+// Ritorna DRV_OK, o DRV_NACK se nessuna flash risponde
+int sfdp_detect(flash_geometry_t *g, uint32_t jedec_id, sfdp_read_t read);
+
+// Stampa su UART la geometria rilevata
+void flash_geometry_report(const flash_geometry_t *g);
+
+#endif // SFDP_H
@@ -1,136 +1,409 @@
-/* 
- * File:   spi.c
- * Author: giada
- *
- * Created on December 9, 2024, 3:37 PM
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-
-#include "spi.h"
-#include "Uart.h"
-#include "Timer.h"
-
-void initSPI1(void)
-{
-    TRISFbits.TRISF2 = 0; // RF2 as Digital Input SDI for flash, SDO for MCU 
-    TRISFbits.TRISF7 = 1; //RF7 ad Digital Output SDO for flash, SDI for MCU
-    TRISFbits.TRISF6 = 0; // RF6 as Digital Output SCK
-    
-    RPF2R = 0x08; // SDI1 ? RF2
-    SDI1R = 0x0F; // SDO1 ? RF7
-    
-    TCS = 0; // RF8 as Digital Output Chip Selection - see #define
-    CS = 1; // Chip select low - see #define
-    
-    SPI1CON = 0x8120; // SPI on, 8-bit master,CKE=1,CKP=0
-//    SPI1CONbits.MSTEN = 1;      // SPI Master enable
-//    SPI1CONbits.CKE = 1;        // Set for SPI Mode 0
-//    SPI1CONbits.ON = 1;         // Enable SPI1
-    SPI1BRG = 15; // Fsck = Fpb/(2 * (15+1))
-}
-
-unsigned char readSPI1(void) {
-    // Avvia la lettura SPI
-    SPI1BUF = 0x00;  // Invia un byte vuoto per avviare la lettura (Master Out, Slave In)
-    
-    // Attendi che la lettura sia completa (SPI1STATbits.SPIRBF  1 quando il buffer di ricezione  pronto)
-    while (!SPI1STATbits.SPIRBF) {
-        // Attendi che il dato venga ricevuto
-    }
-    
-    // Leggi il dato ricevuto dal buffer SPI
-    return SPI1BUF;
-}
-
-
-void EraseFlash(void)
-{
-    // write enable
-    CS = 0;
-    writeSPI1(0x06);
-    CS = 1;
-    Delayms(10);
-    
-
-    // full erase command
-    CS = 0;
-    writeSPI1(0x60);  // Full chip erase command
-    CS = 1;
-    
-    // Polling per attendere la fine dell'operazione di cancellazione
-    CS = 0;
-    writeSPI1(0x05);  // Read status register command
-    unsigned char status = readSPI1();  // Leggi lo stato della flash
-    CS = 1;
-    
-    // Polling: attende finch il bit "Busy" non  0 (Operazione finita)
-    while (status & 0x01) {  // Bit 0 indica se la flash  occupata
-        Delayms(10);  // Attende un po' prima di controllare di nuovo
-        CS = 0;
-        writeSPI1(0x05);  // Leggi di nuovo lo stato
-        status = readSPI1();
-        CS = 1;
-    }
-    
-
-    // Cancellazione completata, disabilita la scrittura
-    CS = 0;
-    writeSPI1(0x04);  // Write disable
-    CS = 1;
-}
-
-
-// send one byte of data and receive one back at the same time
-int writeSPI1( int i)
-{
-    while(!SPI1STATbits.SPITBE);	// wait for TX buffer to be empty
-    SPI1BUF = i; // write to buffer for TX
-    while( !SPI1STATbits.SPIRBF); // wait for transfer complete
-    return (int)SPI1BUF; // read the received value
-}//writeSPI1
-
-
-void writeFlashMem(int addr, short byte){
-    short value = 0;
-    int address = 0;
-    
-    value = byte;
-    address = addr;
-    // write enable
-    CS = 0;
-    writeSPI1(0x06);
-    CS = 1;
-    
-     // send a Write command
-    CS = 0; // select the Serial EEPROM
-    writeSPI1( 0x02); // send command, ignore data Page Program
-    writeSPI1(address >> 16); // send MSB of memory address
-    writeSPI1(address >> 8); // send LSB of memory address
-    writeSPI1(address); // send LSB of memory address
-    writeSPI1(value); // send the actual data
-    // send more data here to perform a page write
-    CS = 1; // start actual EEPROM write cycle
-    
-    // write disable
-    CS = 0;
-    writeSPI1(0x04);
-    CS = 1;
-}
-
-int readFlashMem(int addr)
-{
-    int tmp=0;
-     // send a read command
-    CS = 0; // select the Serial EEPROM
-    writeSPI1(0x03); // send command Read Data, ignore data
-    writeSPI1(addr >> 16); // send MSB of memory address
-    writeSPI1(addr >> 8); // send LSB of memory address
-    writeSPI1(addr); // send LSB of memory address
-
-    tmp = writeSPI1(0); // send dummy, read data 
-
-    CS = 1; // terminate the read sequence
-    return tmp;
-}
\ No newline at end of file
+/* 
+ * File:   spi.c
+ * Author: giada
+ *
+ * Created on December 9, 2024, 3:37 PM
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "spi.h"
+#include "Uart.h"
+#include "Timer.h"
+#include "clock.h"
+#include "drv.h"
+#include "flashcache.h"
+
+flash_geometry_t flash_geo;
+
+static int read_sfdp(uint32_t addr, uint8_t *buf, int len);
+static int flash_read(int addr, uint8_t *buf, int len);
+static int flash_unprotect(void);
+
+void initSPI1(void)
+{
+    TRISFbits.TRISF2 = 0; // RF2 as Digital Input SDI for flash, SDO for MCU 
+    TRISFbits.TRISF7 = 1; //RF7 ad Digital Output SDO for flash, SDI for MCU
+    TRISFbits.TRISF6 = 0; // RF6 as Digital Output SCK
+    
+    RPF2R = 0x08; // SDI1 ? RF2
+    SDI1R = 0x0F; // SDO1 ? RF7
+    
+    TCS = 0; // RF8 as Digital Output Chip Selection - see #define
+    CS = 1; // Chip select low - see #define
+    
+    SPI1CON = 0x8120; // SPI on, 8-bit master,CKE=1,CKP=0
+//    SPI1CONbits.MSTEN = 1;      // SPI Master enable
+//    SPI1CONbits.CKE = 1;        // Set for SPI Mode 0
+//    SPI1CONbits.ON = 1;         // Enable SPI1
+    SPI1BRG = SPI_FLASH_BRG(clock_pbclk()); // 15 con PBCLK = 20MHz
+
+    // Geometria e comandi della flash collegata
+    int id = getFlashID();
+    if (sfdp_detect(&flash_geo, id < 0 ? 0 : id, read_sfdp) == DRV_OK)
+        flash_unprotect();
+}
+
+void SPI1_clock_changed(unsigned int pbclk)
+{
+    SPI1CONbits.ON = 0;
+    SPI1BRG = SPI_FLASH_BRG(pbclk);
+    SPI1CONbits.ON = 1;
+}
+
+// Ogni attesa è limitata: SPI_TIMEOUT_US per byte, timeout in ms per le
+// operazioni interne della flash. Le funzioni ritornano DRV_OK o un codice
+// DRV_ negativo; le letture di un byte ritornano il byte se >= 0
+
+int readSPI1(void) {
+    // Invia un byte vuoto per avviare la lettura (Master Out, Slave In)
+    return writeSPI1(0x00);
+}
+
+
+// Invia comando + indirizzo a 24 bit, CS resta basso
+static int flash_command(int cmd, int addr)
+{
+    if (writeSPI1(cmd) < 0)
+        return DRV_TIMEOUT;
+    if (writeSPI1(addr >> 16) < 0) // send MSB of memory address
+        return DRV_TIMEOUT;
+    if (writeSPI1(addr >> 8) < 0)
+        return DRV_TIMEOUT;
+    if (writeSPI1(addr) < 0) // send LSB of memory address
+        return DRV_TIMEOUT;
+    return DRV_OK;
+}
+
+// JEDEC ID (0x9F): produttore, tipo, capacità
+int getFlashID(void)
+{
+    int id = 0;
+    int status;
+
+    CS = 0;
+    status = writeSPI1(0x9F);
+    for (int i = 0; i < 3 && status >= 0; i++) {
+        status = readSPI1();
+        id = (id << 8) | status;
+    }
+    CS = 1;
+    return status < 0 ? status : id;
+}
+
+// Lettura dello spazio SFDP: comando 0x5A, indirizzo e 8 clock dummy
+static int read_sfdp(uint32_t addr, uint8_t *buf, int len)
+{
+    int status;
+
+    CS = 0;
+    status = flash_command(0x5A, addr);
+    if (status == DRV_OK && readSPI1() < 0)
+        status = DRV_TIMEOUT;
+    while (status == DRV_OK && len--) {
+        int data = readSPI1();
+        if (data < 0)
+            status = data;
+        else
+            *buf++ = data;
+    }
+    CS = 1;
+    return status;
+}
+
+// Comando di un solo byte (write enable, write disable, EWSR)
+static int flash_opcode(int cmd)
+{
+    CS = 0;
+    int status = writeSPI1(cmd);
+    CS = 1;
+    return status < 0 ? status : DRV_OK;
+}
+
+static int flash_write_enable(void)
+{
+    return flash_opcode(0x06);
+}
+
+static int flash_read_status(void)
+{
+    CS = 0;
+    int status = writeSPI1(0x05);
+    if (status >= 0)
+        status = readSPI1();
+    CS = 1;
+    return status;
+}
+
+// Le SST25 si accendono con i bit BP a 1 e le altre parti li conservano
+// se qualcuno li ha scritti: con la memoria protetta programmazione e
+// cancellazione vengono ignorate senza errori. Le SST25 abilitano la
+// scrittura dello status register con EWSR (0x50), le altre con il write
+// enable. Se i bit restano a 1 li blocca il pin WP# (bit BPL/SRP)
+static int flash_unprotect(void)
+{
+    int status = flash_read_status();
+
+    if (status < 0 || !(status & FLASH_SR_BP))
+        return status < 0 ? status : DRV_OK;
+
+    status = flash_opcode(JEDEC_MANUFACTURER(flash_geo.jedec_id) == JEDEC_SST ? 0x50 : 0x06);
+    if (status != DRV_OK)
+        return status;
+    CS = 0;
+    status = writeSPI1(0x01); // Write status register, BP = 0
+    if (status >= 0)
+        status = writeSPI1(0x00);
+    CS = 1;
+    if (status < 0)
+        return status;
+    if ((status = waitFlashReady(FLASH_WRSR_TIMEOUT_MS)) != DRV_OK)
+        return status;
+
+    status = flash_read_status();
+    if (status < 0)
+        return status;
+    flash_geo.locked = (status & FLASH_SR_BP) != 0;
+    return flash_geo.locked ? DRV_UNSUPPORTED : DRV_OK;
+}
+
+
+int EraseFlash(void)
+{
+    int status;
+
+    flashcache_invalidate_all();
+
+    // write enable
+    if ((status = flash_write_enable()) != DRV_OK)
+        return status;
+
+    // full erase command
+    CS = 0;
+    status = writeSPI1(0x60);  // Full chip erase command
+    CS = 1;
+    if (status < 0)
+        return status;
+    
+    // Polling: attende finché il bit "Busy" non è 0 (Operazione finita)
+    if ((status = waitFlashReady(flash_geo.chip_erase_timeout_ms)) != DRV_OK)
+        return status;
+
+    // Cancellazione completata, disabilita la scrittura
+    return flash_opcode(0x04);
+}
+
+
+// Attende la fine di un'operazione di scrittura/cancellazione (bit BUSY)
+int waitFlashReady(unsigned int timeout_ms)
+{
+    unsigned int start = millis();
+    int status;
+
+    do {
+        status = flash_read_status();
+        if (status < 0)
+            return status;
+        if (!(status & FLASH_SR_BUSY))
+            return DRV_OK;
+    } while (millis() - start <= timeout_ms);
+
+    spi1_stats.timeouts++;
+    return DRV_TIMEOUT;
+}
+
+// Cancella solo il settore da 4KB che contiene addr (~50ms invece dei
+// secondi del chip erase), con la cancellazione più piccola della flash.
+// Se la flash cancella solo blocchi più grandi la mappa di spi.h non è
+// utilizzabile: meglio un errore che perdere i settori vicini
+int EraseSector(int addr)
+{
+    int status = DRV_OK;
+
+    if (flash_geo.erase_size > FLASH_SECTOR_SIZE)
+        return DRV_UNSUPPORTED;
+
+    addr &= ~(FLASH_SECTOR_SIZE - 1);
+    flashcache_invalidate(addr, FLASH_SECTOR_SIZE);
+    for (int a = addr; a < addr + FLASH_SECTOR_SIZE && status == DRV_OK; a += flash_geo.erase_size) {
+        // write enable
+        if ((status = flash_write_enable()) != DRV_OK)
+            return status;
+
+        CS = 0;
+        status = flash_command(flash_geo.erase_opcode, a);
+        CS = 1;
+        if (status == DRV_OK)
+            status = waitFlashReady(flash_geo.erase_timeout_ms);
+    }
+    return status;
+}
+
+
+// send one byte of data and receive one back at the same time
+int writeSPI1( int i)
+{
+    if (WAIT_WHILE(!SPI1STATbits.SPITBE, SPI_TIMEOUT_US, spi1_stats) != DRV_OK)	// wait for TX buffer to be empty
+        return DRV_TIMEOUT;
+    SPI1BUF = i; // write to buffer for TX
+    if (WAIT_WHILE(!SPI1STATbits.SPIRBF, SPI_TIMEOUT_US, spi1_stats) != DRV_OK) // wait for transfer complete
+        return DRV_TIMEOUT;
+    return (int)(SPI1BUF & 0xFF); // read the received value
+}//writeSPI1
+
+
+int writeFlashMem(int addr, short byte){
+    int status;
+
+    flashcache_invalidate(addr, 1);
+
+    // write enable
+    if ((status = flash_write_enable()) != DRV_OK)
+        return status;
+    
+     // send a Write command
+    CS = 0; // select the Serial EEPROM
+    status = flash_command(0x02, addr); // send command, ignore data Page Program
+    if (status == DRV_OK && writeSPI1(byte) < 0) // send the actual data
+        status = DRV_TIMEOUT;
+    // send more data here to perform a page write
+    CS = 1; // start actual EEPROM write cycle
+    if (status != DRV_OK)
+        return status;
+    // i comandi inviati durante la programmazione vengono ignorati
+    if ((status = waitFlashReady(flash_geo.program_timeout_ms)) != DRV_OK)
+        return status;
+    
+    // write disable
+    return flash_opcode(0x04);
+}
+
+// Un byte attraverso la cache (flashcache.h)
+int readFlashMem(int addr)
+{
+    unsigned char data;
+    int status = readFlashBlock(addr, &data, 1);
+    return status != DRV_OK ? status : data;
+}
+
+// Una programmazione 0x02 entro una pagina della flash
+static int flash_program(int addr, const unsigned char *data, int len)
+{
+    int status;
+
+    // write enable
+    if ((status = flash_write_enable()) != DRV_OK)
+        return status;
+
+    CS = 0;
+    status = flash_command(0x02, addr); // Page Program
+    for (int i = 0; i < len && status == DRV_OK; i++) {
+        if (writeSPI1(data[i]) < 0)
+            status = DRV_TIMEOUT;
+    }
+    CS = 1; // avvia la programmazione
+    if (status == DRV_OK)
+        status = waitFlashReady(flash_geo.program_timeout_ms);
+    return status;
+}
+
+// SST25: Auto Address Increment, l'indirizzo solo nel primo comando e poi
+// due byte per comando (~10 us ciascuno) invece di una transazione 0x02
+// completa per byte. La sequenza parte da un indirizzo pari e si chiude
+// con il write disable; un byte spaiato all'inizio o alla fine va con 0x02
+static int flash_program_aai(int addr, const unsigned char *data, int len)
+{
+    int status = DRV_OK;
+
+    if (addr & 1) {
+        if ((status = flash_program(addr, data, 1)) != DRV_OK)
+            return status;
+        addr++;
+        data++;
+        len--;
+    }
+    if (len >= 2) {
+        if ((status = flash_write_enable()) != DRV_OK)
+            return status;
+        for (int i = 0; i + 1 < len && status == DRV_OK; i += 2) {
+            CS = 0;
+            if (i == 0)
+                status = flash_command(0xAD, addr);
+            else if (writeSPI1(0xAD) < 0)
+                status = DRV_TIMEOUT;
+            if (status == DRV_OK && (writeSPI1(data[i]) < 0 || writeSPI1(data[i + 1]) < 0))
+                status = DRV_TIMEOUT;
+            CS = 1;
+            if (status == DRV_OK)
+                status = waitFlashReady(flash_geo.program_timeout_ms);
+        }
+        // il write disable chiude la sequenza AAI anche dopo un errore;
+        // lo status register conferma l'uscita
+        int end = flash_opcode(0x04);
+        if (end == DRV_OK)
+            end = flash_read_status();
+        if (status != DRV_OK)
+            return status;
+        if (end < 0)
+            return end;
+        if (end & FLASH_SR_AAI) {
+            spi1_stats.bus_errors++;
+            return DRV_BUS_ERROR;
+        }
+        addr += len & ~1;
+        data += len & ~1;
+        len &= 1;
+    }
+    if (len)
+        status = flash_program(addr, data, 1);
+    return status;
+}
+
+// Programma fino a una pagina (256 byte) a partire da addr. I byte oltre
+// il confine di pagina ricomincerebbero dall'inizio della pagina stessa;
+// se la pagina della flash è più piccola si divide in più programmazioni
+int writeFlashPage(int addr, const unsigned char *data, int len)
+{
+    int status = DRV_OK;
+
+    flashcache_invalidate(addr, len);
+    if (flash_geo.aai)
+        return flash_program_aai(addr, data, len);
+    while (len > 0 && status == DRV_OK) {
+        int chunk = flash_geo.page_size - addr % flash_geo.page_size;
+        if (chunk > len)
+            chunk = len;
+
+        status = flash_program(addr, data, chunk);
+        addr += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+    return status;
+}
+
+// Lettura di len byte a partire da addr, servita dalla cache in RAM se
+// le pagine sono presenti
+int readFlashBlock(int addr, unsigned char *buf, int len)
+{
+    return flashcache_read(addr, buf, len, flash_read);
+}
+
+// Lettura sequenziale diretta dalla flash
+static int flash_read(int addr, uint8_t *buf, int len)
+{
+    int status;
+
+    CS = 0;
+    status = flash_command(FLASH_CMD_READ, addr);
+    while (status == DRV_OK && len--) {
+        int data = writeSPI1(0);
+        if (data < 0)
+            status = data;
+        else
+            *buf++ = data;
+    }
+    CS = 1;
+    return status;
+}
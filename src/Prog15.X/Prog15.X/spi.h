@@ -1,19 +1,72 @@
-/* 
- * File:   newfile.h
- * Author: giada
- *
- * Created on December 9, 2024, 3:38 PM
- */
-
-#include <p32xxxx.h>
-
-#define CS LATFbits.LATF8 // select line for Serial Flash ROM
-#define TCS TRISFbits.TRISF8 // tris control for CS pin
-
-void initSPI1(void);
-void EraseFlash(void);
-int writeSPI1( int i);
-int getFlashID(void);
-void writeFlashMem(int addr, short byte);
-int readFlashMem(int addr);
-
+/* 
+ * File:   newfile.h
+ * Author: giada
+ *
+ * Created on December 9, 2024, 3:38 PM
+ */
+
+#ifndef SPI_H
+#define SPI_H
+
+#include <p32xxxx.h>
+#include "sfdp.h"
+
+#define CS LATFbits.LATF8 // select line for Serial Flash ROM
+#define TCS TRISFbits.TRISF8 // tris control for CS pin
+
+#define SPI_FLASH_HZ 625000
+#define SPI_FLASH_BRG(pbclk) ((pbclk) / (2 * SPI_FLASH_HZ) - 1) // Fsck = Fpb/(2 * (BRG+1))
+
+// Lettura 0x03 senza byte dummy, garantita fino a FLASH_READ_MAX_HZ. Il
+// comando dipende solo dal clock di SPI1, non da SFDP: le tabelle
+// descrivono solo le fast read multi-I/O, che SPI1 non può usare
+#define FLASH_CMD_READ      0x03
+#define FLASH_READ_MAX_HZ   33000000
+#if SPI_FLASH_HZ > FLASH_READ_MAX_HZ
+#error "SPI1 oltre FLASH_READ_MAX_HZ: serve il fast read 0x0B con un byte dummy"
+#endif
+
+// Tempi massimi delle operazioni interne della flash, usati se la flash
+// non li dichiara nelle tabelle SFDP (sfdp.h)
+#define FLASH_PROGRAM_TIMEOUT_MS        5
+#define FLASH_SECTOR_ERASE_TIMEOUT_MS   500
+#define FLASH_CHIP_ERASE_TIMEOUT_MS     120000
+#define FLASH_WRSR_TIMEOUT_MS           15
+
+// Status register: BUSY, bit di protezione a blocchi BP0-BP3 e, sulle
+// SST25, sequenza AAI in corso
+#define FLASH_SR_BUSY   0x01
+#define FLASH_SR_BP     0x3C
+#define FLASH_SR_AAI    0x40
+
+#define FLASH_PAGE_SIZE 256
+#define FLASH_SECTOR_SIZE 4096
+
+// Mappa della flash
+// 0x000000-0x001000 riservato (ultima detezione nelle versioni precedenti,
+// ora in settings.h)
+#define LOG_START_ADDR      0x001000 // log dei campioni compressi (codec.h)
+#define LOG_END_ADDR        0x101000 // 256 settori, 1MB
+#define CAPTURE_START_ADDR  0x101000 // catture con trigger (capture.h), un settore ciascuna
+#define CAPTURE_END_ADDR    0x141000 // 64 settori
+#define SETTINGS_START_ADDR 0x141000 // impostazioni persistenti (settings.h)
+#define SETTINGS_END_ADDR   0x149000 // 8 settori a rotazione
+
+void initSPI1(void);
+void SPI1_clock_changed(unsigned int pbclk);
+int EraseFlash(void);
+int EraseSector(int addr);
+int waitFlashReady(unsigned int timeout_ms);
+int writeSPI1( int i);
+int readSPI1(void);
+int getFlashID(void);
+int writeFlashMem(int addr, short byte);
+int readFlashMem(int addr);
+int writeFlashPage(int addr, const unsigned char *data, int len);
+int readFlashBlock(int addr, unsigned char *buf, int len);
+
+// Geometria rilevata da initSPI1()
+extern flash_geometry_t flash_geo;
+
+#endif // SPI_H
+
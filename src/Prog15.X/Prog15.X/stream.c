@@ -0,0 +1,77 @@
+/* 
+ * File:   stream.c
+ * 
+ * Streaming CSV dei campioni: "t_ms,ch0,ch1,lux,gain"
+ */
+
+#include <stdio.h>
+#include "stream.h"
+#include "samples.h"
+#include "Uart.h"
+#include "drv.h"
+
+#define RECORD_MAX 40   // riga CSV più lunga
+
+static char buffers[2][STREAM_BUF_SIZE];
+static int fill = 0;        // buffer in riempimento
+static int fill_length = 0;
+static int active = 0;
+
+static sample_reader_t reader;
+static unsigned int sent = 0;
+static unsigned int dropped = 0;
+
+void stream_start(void) {
+    fill = 0;
+    sent = 0;
+    dropped = 0;
+    samples_attach(&reader, "Streaming");
+    // L'intestazione parte con il primo buffer, senza attendere la fine
+    // del menu ancora in trasmissione
+    fill_length = snprintf(buffers[fill], STREAM_BUF_SIZE, "t_ms,ch0,ch1,lux,gain\r\n");
+    active = 1;
+}
+
+void stream_stop(void) {
+    char buffer[64];
+
+    stream_poll();
+    active = 0;
+    stream_poll(); // invia il buffer rimasto, dopo quello in trasmissione
+    dropped = reader.lost + samples_pending(&reader);
+    snprintf(buffer, sizeof(buffer), "Streaming: %u campioni inviati, %u persi\r\n", sent, dropped);
+    UART4_WriteString(buffer);
+}
+
+int stream_active(void) {
+    return active;
+}
+
+int stream_poll(void) {
+    const sample_t *s;
+    int consumed = 0;
+
+    // Se la seriale non tiene il passo i campioni restano nel ring
+    while (active && fill_length + RECORD_MAX <= STREAM_BUF_SIZE && (s = samples_peek(&reader))) {
+        fill_length += snprintf(&buffers[fill][fill_length], RECORD_MAX, "%lu,%u,%u,%u,%d\r\n",
+                                (unsigned long)s->time, s->ch0, s->ch1, s->lux, s->gain);
+        samples_advance(&reader);
+        sent++;
+        consumed = 1;
+    }
+
+    if (fill_length == 0)
+        return consumed;
+    if (!active) {
+        UART4_StartTx(buffers[fill], fill_length); // chiusura: attesa limitata
+    } else if (UART4_TxBusy() || UART4_StartTx(buffers[fill], fill_length) != DRV_OK) {
+        return consumed;
+    }
+    fill ^= 1;
+    fill_length = 0;
+    return 1;
+}
+
+unsigned int stream_dropped(void) {
+    return active ? reader.lost : dropped;
+}
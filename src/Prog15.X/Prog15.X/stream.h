@@ -0,0 +1,32 @@
+/* 
+ * File:   stream.h
+ * 
+ * Streaming della telemetria su UART4 con doppio buffer: un buffer si
+ * riempie mentre l'altro viene trasmesso a interrupt. I campioni arrivano
+ * dal ring di samples.h con un cursore proprio, alla velocità della seriale
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include <stdint.h>
+
+#define STREAM_BUF_SIZE 256
+
+// Avvia lo streaming (stampa l'intestazione CSV e azzera i contatori)
+void stream_start(void);
+
+// Termina lo streaming e stampa i contatori
+void stream_stop(void);
+
+int stream_active(void);
+
+// Formatta i campioni nuovi finché il buffer in riempimento ha spazio e
+// lo trasmette quando la UART è libera, senza mai attenderla. I campioni
+// sovrascritti nel ring prima di essere formattati sono contati come persi.
+// Ritorna 1 se ha consumato campioni
+int stream_poll(void);
+
+unsigned int stream_dropped(void);
+
+#endif // STREAM_H
@@ -0,0 +1,228 @@
+/*
+ * File:   aggregate.cc
+ *
+ * Kernel delle aggregazioni. La somma dei lux in AVX2 separa byte bassi e
+ * alti di ogni valore a 16 bit e li somma con _mm256_sad_epu8 in
+ * accumulatori a 64 bit: nessun overflow anche su milioni di campioni.
+ * L'istogramma resta scalare ma usa quattro tabelle parziali, così gli
+ * incrementi consecutivi non dipendono l'uno dall'altro.
+ */
+
+#include "aggregate.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS 1
+#endif
+
+void summary_t::merge(const summary_t &o) {
+    count += o.count;
+    sum += o.sum;
+    min = std::min(min, o.min);
+    max = std::max(max, o.max);
+    above_ms += o.above_ms;
+    episodes += o.episodes;
+}
+
+// ---------------------------------------------------------------- Scalari
+
+static void minmax_sum_scalar(const uint16_t *x, size_t n, summary_t &s) {
+    uint16_t mn = s.min, mx = s.max;
+    uint64_t sum = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        mn = std::min(mn, x[i]);
+        mx = std::max(mx, x[i]);
+        sum += x[i];
+    }
+    s.min = mn;
+    s.max = mx;
+    s.sum += sum;
+}
+
+// Tempo sopra soglia per le coppie (i, i + 1), i < n: time ha n + 1 elementi
+static uint64_t above_ms_scalar(const uint16_t *lux, const uint32_t *time, size_t n, uint16_t threshold) {
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        if (lux[i] >= threshold)
+            total += time[i + 1] - time[i];
+    }
+    return total;
+}
+
+// Campioni sopra soglia con il precedente sotto soglia (prev per il primo)
+static uint64_t rising_scalar(const uint16_t *lux, size_t n, uint16_t threshold, bool prev) {
+    uint64_t count = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        bool above = lux[i] >= threshold;
+        count += above && !prev;
+        prev = above;
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------- AVX2
+
+#ifdef HAVE_AVX2_KERNELS
+
+__attribute__((target("avx2")))
+static uint64_t hsum_epi64(__m256i v) {
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return (uint64_t)_mm_cvtsi128_si64(s) + (uint64_t)_mm_extract_epi64(s, 1);
+}
+
+__attribute__((target("avx2")))
+static void minmax_sum_avx2(const uint16_t *x, size_t n, summary_t &s) {
+    size_t i = 0;
+
+    if (n >= 16) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i low = _mm256_set1_epi16(0x00FF);
+        __m256i vmin = _mm256_set1_epi16((short)s.min);
+        __m256i vmax = _mm256_set1_epi16((short)s.max);
+        __m256i acc_lo = zero, acc_hi = zero;
+
+        for (; i + 16 <= n; i += 16) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(x + i));
+            vmin = _mm256_min_epu16(vmin, v);
+            vmax = _mm256_max_epu16(vmax, v);
+            acc_lo = _mm256_add_epi64(acc_lo, _mm256_sad_epu8(_mm256_and_si256(v, low), zero));
+            acc_hi = _mm256_add_epi64(acc_hi, _mm256_sad_epu8(_mm256_srli_epi16(v, 8), zero));
+        }
+
+        // Riduzione orizzontale: min/max su 8 valori, poi su 4, 2, 1
+        __m128i m = _mm_min_epu16(_mm256_castsi256_si128(vmin), _mm256_extracti128_si256(vmin, 1));
+        __m128i M = _mm_max_epu16(_mm256_castsi256_si128(vmax), _mm256_extracti128_si256(vmax, 1));
+        s.min = (uint16_t)_mm_extract_epi16(_mm_minpos_epu16(m), 0);
+        // max(x) = ~min(~x)
+        M = _mm_xor_si128(M, _mm_set1_epi16(-1));
+        s.max = (uint16_t)~_mm_extract_epi16(_mm_minpos_epu16(M), 0);
+        s.sum += hsum_epi64(acc_lo) + (hsum_epi64(acc_hi) << 8);
+    }
+    minmax_sum_scalar(x + i, n - i, s);
+}
+
+__attribute__((target("avx2")))
+static uint64_t above_ms_avx2(const uint16_t *lux, const uint32_t *time, size_t n, uint16_t threshold) {
+    const __m256i thr = _mm256_set1_epi32((int)threshold - 1);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        __m256i t0 = _mm256_loadu_si256((const __m256i *)(time + i));
+        __m256i t1 = _mm256_loadu_si256((const __m256i *)(time + i + 1));
+        __m256i l = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(lux + i)));
+        __m256i dt = _mm256_and_si256(_mm256_sub_epi32(t1, t0), _mm256_cmpgt_epi32(l, thr));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(dt)));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(dt, 1)));
+    }
+    return hsum_epi64(acc) + above_ms_scalar(lux + i, time + i, n - i, threshold);
+}
+
+__attribute__((target("avx2,popcnt")))
+static uint64_t rising_avx2(const uint16_t *lux, size_t n, uint16_t threshold, bool prev) {
+    const __m256i thr = _mm256_set1_epi16((short)threshold);
+    uint64_t count = 0;
+    size_t i = 1;
+
+    if (n == 0)
+        return 0;
+    count += lux[0] >= threshold && !prev;
+    for (; i + 16 <= n; i += 16) {
+        __m256i cur = _mm256_loadu_si256((const __m256i *)(lux + i));
+        __m256i before = _mm256_loadu_si256((const __m256i *)(lux + i - 1));
+        // x >= soglia <=> max(x, soglia) == x (confronto senza segno)
+        __m256i above = _mm256_cmpeq_epi16(_mm256_max_epu16(cur, thr), cur);
+        __m256i was = _mm256_cmpeq_epi16(_mm256_max_epu16(before, thr), before);
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_andnot_si256(was, above));
+        count += __builtin_popcount(mask) / 2; // due bit per valore a 16 bit
+    }
+    return count + rising_scalar(lux + i, n - i, threshold, lux[i - 1] >= threshold);
+}
+
+#endif // HAVE_AVX2_KERNELS
+
+// ---------------------------------------------------------------- Dispatch
+
+struct kernels_t {
+    const char *name;
+    void (*minmax_sum)(const uint16_t *, size_t, summary_t &);
+    uint64_t (*above_ms)(const uint16_t *, const uint32_t *, size_t, uint16_t);
+    uint64_t (*rising)(const uint16_t *, size_t, uint16_t, bool);
+};
+
+static const kernels_t scalar_kernels = { "scalare", minmax_sum_scalar, above_ms_scalar, rising_scalar };
+
+static bool avx2_supported() {
+#ifdef HAVE_AVX2_KERNELS
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#else
+    return false;
+#endif
+}
+
+static kernels_t select_kernels() {
+#ifdef HAVE_AVX2_KERNELS
+    if (avx2_supported())
+        return { "avx2", minmax_sum_avx2, above_ms_avx2, rising_avx2 };
+#endif
+    return scalar_kernels;
+}
+
+static kernels_t kernels = select_kernels();
+
+const char *kernel_name() {
+    return kernels.name;
+}
+
+bool select_kernel(const char *name) {
+    if (!strcmp(name, scalar_kernels.name)) {
+        kernels = scalar_kernels;
+        return true;
+    }
+    if (!strcmp(name, "avx2") && avx2_supported()) {
+        kernels = select_kernels();
+        return true;
+    }
+    return false;
+}
+
+void summarize(const uint16_t *lux, const uint32_t *time, size_t start, size_t a, size_t b,
+               size_t end, uint16_t threshold, summary_t &s) {
+    if (b <= a)
+        return;
+    s.count += b - a;
+    kernels.minmax_sum(lux + a, b - a, s);
+
+    size_t pairs_end = std::min(b, end - 1);
+    if (pairs_end > a)
+        s.above_ms += kernels.above_ms(lux + a, time + a, pairs_end - a, threshold);
+    bool prev = a > start && lux[a - 1] >= threshold;
+    s.episodes += kernels.rising(lux + a, b - a, threshold, prev);
+}
+
+void histogram(const uint16_t *lux, size_t n, unsigned int width, std::vector<uint64_t> &bins) {
+    size_t nb = bins.size();
+    std::vector<uint64_t> part(4 * nb, 0);
+    // lux / width con una moltiplicazione: esatto per lux e width < 2^16
+    uint64_t reciprocal = ((1ULL << 32) + width - 1) / width;
+    size_t last = nb - 1;
+    size_t i = 0;
+
+    auto bin = [&](uint16_t x) { return std::min<size_t>((x * reciprocal) >> 32, last); };
+    for (; i + 4 <= n; i += 4) {
+        part[bin(lux[i])]++;
+        part[nb + bin(lux[i + 1])]++;
+        part[2 * nb + bin(lux[i + 2])]++;
+        part[3 * nb + bin(lux[i + 3])]++;
+    }
+    for (; i < n; i++)
+        part[bin(lux[i])]++;
+    for (size_t k = 0; k < nb; k++)
+        bins[k] += part[k] + part[nb + k] + part[2 * nb + k] + part[3 * nb + k];
+}
@@ -0,0 +1,46 @@
+/*
+ * File:   aggregate.h
+ *
+ * Aggregazioni sui campioni decodificati, in layout a colonne (lux e
+ * timestamp in array separati). Ogni kernel ha una versione AVX2 scelta a
+ * runtime se la CPU la supporta e una scalare equivalente.
+ */
+
+#ifndef ANALYTICS_AGGREGATE_H
+#define ANALYTICS_AGGREGATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct summary_t {
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint16_t min = UINT16_MAX;
+    uint16_t max = 0;
+    uint64_t above_ms = 0;  // tempo con lux >= soglia
+    uint64_t episodes = 0;  // ingressi sopra la soglia
+
+    void merge(const summary_t &o);
+    double mean() const { return count ? (double)sum / count : 0.0; }
+};
+
+// Riassunto dei campioni [a, b) di una sessione che termina in end (esclusa).
+// Il tempo sopra soglia di un campione va fino al campione successivo della
+// stessa sessione; l'episodio inizia quando il campione precedente (anche
+// prima di a) era sotto soglia.
+void summarize(const uint16_t *lux, const uint32_t *time, size_t start, size_t a, size_t b,
+               size_t end, uint16_t threshold, summary_t &s);
+
+// Istogramma dei lux con bin di larghezza width, l'ultimo bin raccoglie
+// anche i valori oltre il limite
+void histogram(const uint16_t *lux, size_t n, unsigned int width, std::vector<uint64_t> &bins);
+
+// Nome della versione dei kernel in uso ("avx2" o "scalare")
+const char *kernel_name();
+
+// Forza una versione dei kernel per nome, false se non esiste o la CPU
+// non la supporta (confronto fra le versioni in make check)
+bool select_kernel(const char *name);
+
+#endif // ANALYTICS_AGGREGATE_H
@@ -0,0 +1,429 @@
+/*
+ * File:   fleetstat.cc
+ *
+ * Analisi su PC dei dati di più schede: legge immagini della flash SPI
+ * (anche concatenate in un unico archivio) o export CSV della seriale,
+ * decodifica i blocchi del log scritti da datalog.c con il codec del
+ * firmware e calcola per dispositivo, sessione e ora di funzionamento
+ * minimo, massimo, media, tempo sopra soglia ed episodi, più un
+ * istogramma dei lux di tutta la flotta.
+ *
+ * I file sono mappati in memoria e ogni immagine è un'unità di lavoro: i
+ * thread prendono la prossima immagine libera da un contatore atomico. I
+ * campioni decodificati sono tenuti a colonne (lux e timestamp separati)
+ * per i kernel vettoriali di aggregate.cc.
+ *
+ * I timestamp del firmware sono millisecondi dall'avvio: una sessione
+ * finisce quando il tempo torna indietro (riavvio) e le "ore" sono ore di
+ * funzionamento nella sessione.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern "C" {
+#include "codec.h"
+#include "spi.h"
+}
+
+#include "aggregate.h"
+
+#define MS_PER_HOUR     3600000ULL
+#define MAX_LUX_BIN     20000   // oltre, tutto nell'ultimo bin dell'istogramma
+
+struct options_t {
+    uint16_t threshold = 500;
+    unsigned int bin_width = 100;
+    size_t image_size = 0;      // 0: ogni file è un'immagine
+    unsigned int threads = 0;
+    const char *hourly_path = nullptr;
+    const char *histogram_path = nullptr;
+};
+
+struct image_t {
+    std::string name;
+    const uint8_t *data;
+    size_t size;
+    bool text;
+};
+
+struct hour_row_t {
+    uint32_t session;
+    uint64_t hour;
+    summary_t s;
+};
+
+struct device_t {
+    uint64_t blocks = 0;
+    uint64_t corrupt = 0;
+    uint32_t sessions = 0;
+    summary_t total;
+    std::vector<hour_row_t> hours;
+    std::vector<uint64_t> bins;
+};
+
+// Colonne dei campioni di un'immagine, riusate dal thread fra un'immagine e l'altra
+struct columns_t {
+    std::vector<uint16_t> lux;
+    std::vector<uint32_t> time;
+};
+
+static void usage() {
+    fprintf(stderr,
+        "Uso: fleetstat [-t lux] [-w lux] [-s dimensione] [-j thread] [-k kernel] [-o orario.csv] [-g istogramma.csv] file...\n"
+        "  file  immagine della flash (es. build/replay -f), archivio di immagini\n"
+        "        concatenate con -s, oppure export della seriale .csv/.txt\n"
+        "        (streaming t_ms,ch0,ch1,lux,gain o cattura t_ms,lux)\n"
+        "  -t  soglia per tempo sopra soglia ed episodi (default 500 lux)\n"
+        "  -w  larghezza dei bin dell'istogramma (default 100 lux)\n"
+        "  -s  dimensione di ogni immagine nell'archivio, suffissi K e M (es. 4M)\n"
+        "  -j  thread (default: tutti i core)\n"
+        "  -k  kernel delle aggregazioni, avx2 o scalare (default: avx2 se la CPU lo supporta)\n"
+        "  -o  CSV per dispositivo, sessione e ora\n"
+        "  -g  CSV dell'istogramma della flotta\n");
+    exit(2);
+}
+
+static size_t parse_size(const char *s) {
+    char *end;
+    size_t v = strtoull(s, &end, 0);
+    if (*end == 'K' || *end == 'k')
+        v <<= 10;
+    else if (*end == 'M' || *end == 'm')
+        v <<= 20;
+    return v;
+}
+
+// ---------------------------------------------------------------- Decodifica
+
+// Blocchi del log in ordine di sequenza: il log è circolare, l'ordine
+// fisico delle pagine non è quello temporale
+static void decode_flash(const image_t &img, device_t &d, columns_t &c) {
+    struct block_ref_t {
+        uint32_t seq;
+        uint32_t offset;
+    };
+    std::vector<block_ref_t> blocks;
+    size_t end = std::min<size_t>(img.size, LOG_END_ADDR);
+    codec_header_t h;
+    size_t samples = 0;
+
+    for (size_t a = LOG_START_ADDR; a + FLASH_PAGE_SIZE <= end; a += FLASH_PAGE_SIZE) {
+        if (codec_read_header(img.data + a, &h)) {
+            blocks.push_back({ h.seq, (uint32_t)a });
+            samples += h.count;
+        }
+    }
+    std::sort(blocks.begin(), blocks.end(),
+              [](const block_ref_t &x, const block_ref_t &y) { return x.seq < y.seq; });
+
+    // Colonne dimensionate dagli header, poi accorciate ai campioni validi
+    c.lux.resize(samples);
+    c.time.resize(samples);
+    size_t used = 0;
+    lux_record_t records[CODEC_MAX_SAMPLES];
+    for (const block_ref_t &b : blocks) {
+        int n = codec_block_decode(img.data + b.offset, records, CODEC_MAX_SAMPLES);
+        if (n < 0) {
+            d.corrupt++;
+            continue;
+        }
+        d.blocks++;
+        uint16_t *lux = &c.lux[used];
+        uint32_t *time = &c.time[used];
+        for (int i = 0; i < n; i++) {
+            lux[i] = records[i].lux;
+            time[i] = records[i].time;
+        }
+        used += n;
+    }
+    c.lux.resize(used);
+    c.time.resize(used);
+}
+
+// Numero decimale in [q, eol): il file mappato non finisce con un NUL, quindi
+// niente strtoul, che su un'ultima riga senza a capo leggerebbe oltre la mappatura
+static const char *parse_field(const char *q, const char *eol, unsigned long &v) {
+    v = 0;
+    while (q < eol && *q >= '0' && *q <= '9')
+        v = v * 10 + (*q++ - '0');
+    return q;
+}
+
+// Righe numeriche dell'export: 5 campi (streaming) o 2 (cattura)
+static void decode_text(const image_t &img, columns_t &c) {
+    const char *p = (const char *)img.data;
+    const char *end = p + img.size;
+
+    while (p < end) {
+        const char *eol = (const char *)memchr(p, '\n', end - p);
+        if (!eol)
+            eol = end;
+        if (*p >= '0' && *p <= '9') {
+            unsigned long f[5];
+            int n = 0;
+            const char *q = p;
+            while (n < 5 && q < eol) {
+                q = parse_field(q, eol, f[n++]);
+                if (q >= eol || *q != ',')
+                    break;
+                q++;
+            }
+            if (n == 5 || n == 2) {
+                c.time.push_back((uint32_t)f[0]);
+                c.lux.push_back((uint16_t)std::min(f[n == 5 ? 3 : 1], 65535UL));
+            }
+        }
+        p = eol + 1;
+    }
+}
+
+// ---------------------------------------------------------------- Analisi
+
+static void analyze(device_t &d, const columns_t &c, const options_t &o) {
+    const uint16_t *lux = c.lux.data();
+    const uint32_t *time = c.time.data();
+    size_t n = c.lux.size();
+
+    d.bins.assign(MAX_LUX_BIN / o.bin_width + 1, 0);
+    histogram(lux, n, o.bin_width, d.bins);
+
+    for (size_t start = 0; start < n;) {
+        size_t end = start + 1;
+        while (end < n && time[end] >= time[end - 1])
+            end++;
+
+        // Un riassunto per ogni ora della sessione, i limiti per bisezione
+        for (size_t a = start; a < end;) {
+            uint64_t hour = time[a] / MS_PER_HOUR;
+            uint64_t limit = (hour + 1) * MS_PER_HOUR;
+            size_t b = std::partition_point(time + a, time + end,
+                                            [limit](uint32_t t) { return t < limit; }) - time;
+            summary_t s;
+            summarize(lux, time, start, a, b, end, o.threshold, s);
+            d.total.merge(s);
+            if (o.hourly_path)
+                d.hours.push_back({ d.sessions, hour, s });
+            a = b;
+        }
+        d.sessions++;
+        start = end;
+    }
+}
+
+// ---------------------------------------------------------------- Ingresso
+
+static bool is_text(const char *path) {
+    const char *dot = strrchr(path, '.');
+    return dot && (!strcmp(dot, ".csv") || !strcmp(dot, ".txt") || !strcmp(dot, ".log"));
+}
+
+// Mappa il file e lo divide in immagini; la mappatura resta fino all'uscita
+static bool map_file(const char *path, const options_t &o, std::vector<image_t> &images, size_t &mapped) {
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+
+    if (fd < 0 || fstat(fd, &st) < 0) {
+        perror(path);
+        if (fd >= 0)
+            close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        close(fd);
+        return true;
+    }
+    void *p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        perror(path);
+        return false;
+    }
+    madvise(p, size, MADV_WILLNEED);
+    mapped += size;
+
+    const uint8_t *data = (const uint8_t *)p;
+    bool text = is_text(path);
+    if (text || !o.image_size || size <= o.image_size) {
+        images.push_back({ path, data, size, text });
+        return true;
+    }
+    if (size % o.image_size)
+        fprintf(stderr, "%s: %zu byte finali ignorati (non multipli di -s)\n", path, size % o.image_size);
+    for (size_t i = 0; i + o.image_size <= size; i += o.image_size)
+        images.push_back({ std::string(path) + "#" + std::to_string(i / o.image_size),
+                           data + i, o.image_size, false });
+    return true;
+}
+
+// ---------------------------------------------------------------- Uscite
+
+static void print_summary(const std::vector<image_t> &images, const std::vector<device_t> &devices,
+                          const options_t &o) {
+    device_t fleet;
+
+    printf("%-28s %8s %8s %8s %10s %6s %6s %8s %12s %8s\n", "dispositivo", "sessioni", "blocchi",
+           "corrotti", "campioni", "min", "max", "media", "sopra_ms", "episodi");
+    auto line = [](const char *name, const device_t &d) {
+        printf("%-28s %8u %8llu %8llu %10llu %6u %6u %8.1f %12llu %8llu\n", name, d.sessions,
+               (unsigned long long)d.blocks, (unsigned long long)d.corrupt,
+               (unsigned long long)d.total.count, d.total.count ? d.total.min : 0, d.total.max,
+               d.total.mean(), (unsigned long long)d.total.above_ms,
+               (unsigned long long)d.total.episodes);
+    };
+    for (size_t i = 0; i < devices.size(); i++) {
+        line(images[i].name.c_str(), devices[i]);
+        fleet.sessions += devices[i].sessions;
+        fleet.blocks += devices[i].blocks;
+        fleet.corrupt += devices[i].corrupt;
+        fleet.total.merge(devices[i].total);
+    }
+    if (devices.size() > 1)
+        line("flotta", fleet);
+    printf("soglia %u lux\n", o.threshold);
+}
+
+static bool write_hourly(const char *path, const std::vector<image_t> &images,
+                         const std::vector<device_t> &devices) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    fprintf(f, "device,session,hour,samples,min,max,mean,above_ms,episodes\n");
+    for (size_t i = 0; i < devices.size(); i++) {
+        for (const hour_row_t &r : devices[i].hours)
+            fprintf(f, "%s,%u,%llu,%llu,%u,%u,%.2f,%llu,%llu\n", images[i].name.c_str(), r.session,
+                    (unsigned long long)r.hour, (unsigned long long)r.s.count, r.s.min, r.s.max,
+                    r.s.mean(), (unsigned long long)r.s.above_ms, (unsigned long long)r.s.episodes);
+    }
+    fclose(f);
+    return true;
+}
+
+static bool write_histogram(const char *path, const std::vector<device_t> &devices, const options_t &o) {
+    std::vector<uint64_t> bins(MAX_LUX_BIN / o.bin_width + 1, 0);
+    FILE *f = fopen(path, "w");
+
+    if (!f) {
+        perror(path);
+        return false;
+    }
+    for (const device_t &d : devices) {
+        for (size_t k = 0; k < d.bins.size(); k++)
+            bins[k] += d.bins[k];
+    }
+    fprintf(f, "lux_from,lux_to,samples\n");
+    for (size_t k = 0; k < bins.size(); k++) {
+        unsigned int from = k * o.bin_width;
+        if (k + 1 < bins.size())
+            fprintf(f, "%u,%u,%llu\n", from, from + o.bin_width - 1, (unsigned long long)bins[k]);
+        else
+            fprintf(f, "%u,65535,%llu\n", from, (unsigned long long)bins[k]);
+    }
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    options_t o;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:w:s:j:k:o:g:")) != -1) {
+        switch (opt) {
+        case 't':
+            o.threshold = (uint16_t)strtoul(optarg, nullptr, 10);
+            break;
+        case 'w':
+            o.bin_width = (unsigned int)strtoul(optarg, nullptr, 10);
+            if (o.bin_width == 0 || o.bin_width > MAX_LUX_BIN)
+                usage();
+            break;
+        case 's':
+            o.image_size = parse_size(optarg);
+            if (o.image_size < LOG_END_ADDR)
+                usage(); // l'immagine deve contenere tutto il log
+            break;
+        case 'j':
+            o.threads = (unsigned int)strtoul(optarg, nullptr, 10);
+            break;
+        case 'k':
+            if (!select_kernel(optarg)) {
+                fprintf(stderr, "kernel %s non disponibile\n", optarg);
+                return 2;
+            }
+            break;
+        case 'o':
+            o.hourly_path = optarg;
+            break;
+        case 'g':
+            o.histogram_path = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind >= argc)
+        usage();
+
+    std::vector<image_t> images;
+    size_t mapped = 0;
+    for (int i = optind; i < argc; i++) {
+        if (!map_file(argv[i], o, images, mapped))
+            return 2;
+    }
+
+    unsigned int threads = o.threads ? o.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, std::max<size_t>(images.size(), 1));
+    std::vector<device_t> devices(images.size());
+    std::atomic<size_t> next(0);
+    auto start = std::chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        columns_t c;
+        size_t i;
+        while ((i = next++) < images.size()) {
+            c.lux.clear();
+            c.time.clear();
+            if (images[i].text)
+                decode_text(images[i], c);
+            else
+                decode_flash(images[i], devices[i], c);
+            analyze(devices[i], c, o);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker();
+    for (std::thread &t : pool)
+        t.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint64_t samples = 0;
+    for (const device_t &d : devices)
+        samples += d.total.count;
+
+    print_summary(images, devices, o);
+    if (o.hourly_path && !write_hourly(o.hourly_path, images, devices))
+        return 2;
+    if (o.histogram_path && !write_histogram(o.histogram_path, devices, o))
+        return 2;
+    fprintf(stderr, "%zu immagini, %.1f MB in %.3f s (%.2f GB/s), %.1f M campioni/s, %u thread, kernel %s\n",
+            images.size(), mapped / 1e6, seconds, seconds > 0 ? mapped / seconds / 1e9 : 0.0,
+            seconds > 0 ? samples / seconds / 1e6 : 0.0, threads, kernel_name());
+    return 0;
+}
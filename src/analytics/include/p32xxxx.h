@@ -0,0 +1,11 @@
+/*
+ * File:   p32xxxx.h (analytics)
+ *
+ * spi.h è incluso solo per la mappa della flash (LOG_START_ADDR...):
+ * nessun registro del PIC32 serve su PC.
+ */
+
+#ifndef ANALYTICS_P32XXXX_H
+#define ANALYTICS_P32XXXX_H
+
+#endif // ANALYTICS_P32XXXX_H
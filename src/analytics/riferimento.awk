@@ -0,0 +1,55 @@
+# Riferimento di make check, indipendente dai kernel di aggregate.cc:
+# campioni, min, max, tempo sopra soglia ed episodi di un export della
+# seriale (streaming t_ms,ch0,ch1,lux,gain o cattura t_ms,lux), con le
+# stesse definizioni di fleetstat. Le sessioni finiscono quando il tempo
+# torna indietro. Con larghezza stampa invece l'istogramma nel formato di
+# fleetstat -g (divisione vera invece del reciproco di aggregate.cc).
+#
+#   awk -v soglia=500 -f riferimento.awk export.csv
+#   awk -v larghezza=7 -f riferimento.awk export.csv
+
+BEGIN {
+    FS = ","
+    soglia += 0
+    min = 65536
+    max = 0
+    if (larghezza)
+        ultimo = int(20000 / larghezza) # MAX_LUX_BIN di fleetstat.cc
+}
+
+/^[0-9]/ && (NF == 5 || NF == 2) {
+    t = $1 + 0
+    lux = (NF == 5 ? $4 : $2) + 0
+    if (lux > 65535)
+        lux = 65535
+    sopra = lux >= soglia
+    if (n && t >= prev_t) {
+        if (prev_sopra)
+            sopra_ms += t - prev_t
+    } else {
+        prev_sopra = 0 # nuova sessione
+    }
+    if (sopra && !prev_sopra)
+        episodi++
+    if (lux < min)
+        min = lux
+    if (lux > max)
+        max = lux
+    if (larghezza) {
+        k = int(lux / larghezza)
+        bins[k > ultimo ? ultimo : k]++
+    }
+    n++
+    prev_t = t
+    prev_sopra = sopra
+}
+
+END {
+    if (!larghezza) {
+        printf "%d %d %d %d %d\n", n, n ? min : 0, max, sopra_ms, episodi
+        exit
+    }
+    print "lux_from,lux_to,samples"
+    for (k = 0; k <= ultimo; k++)
+        printf "%d,%d,%d\n", k * larghezza, k < ultimo ? k * larghezza + larghezza - 1 : 65535, bins[k]
+}
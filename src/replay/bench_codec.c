@@ -0,0 +1,185 @@
+/*
+ * File:   bench_codec.c
+ *
+ * Benchmark su host del codec a blocchi del log in flash (codec.h) sulle
+ * tracce registrate: codifica i campioni come datalog.c, un blocco per
+ * pagina, li decodifica e controlla che il giro sia senza perdite.
+ * Stampa throughput di codifica e decodifica e il rapporto di
+ * compressione, da confrontare con il menu 4 sulla scheda.
+ *
+ *   make bench
+ *   build/bench_codec traccia.csv...
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "codec.h"
+
+#define BENCH_MS    1000
+#define MAX_LINE    128
+// Formato grezzo di riferimento, come in datalog_report(): lux 16 bit +
+// timestamp 32 bit
+#define RAW_SAMPLE_BYTES (sizeof(uint16_t) + sizeof(uint32_t))
+
+typedef struct {
+    lux_record_t *samples;
+    int count;
+    uint8_t (*blocks)[CODEC_BLOCK_SIZE];    // una pagina della flash per blocco
+    int num_blocks;
+    unsigned long encoded;                  // byte usati nei blocchi
+} bench_trace_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Cattura seriale del menu 5 (t_ms,ch0,ch1,lux,gain): si codificano i lux
+// calcolati dal firmware con il loro timestamp, come fa il log in flash
+static int load_trace(const char *path, bench_trace_t *b) {
+    char line[MAX_LINE];
+    int capacity = 1024;
+    unsigned long t;
+    unsigned int ch0, ch1, lux;
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        return 0;
+    }
+    b->samples = malloc(capacity * sizeof(lux_record_t));
+    b->count = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "%lu,%u,%u,%u", &t, &ch0, &ch1, &lux) != 4)
+            continue;
+        if (b->count == capacity) {
+            capacity *= 2;
+            b->samples = realloc(b->samples, capacity * sizeof(lux_record_t));
+        }
+        b->samples[b->count].lux = (uint16_t)lux;
+        b->samples[b->count].time = (uint32_t)t;
+        b->count++;
+    }
+    fclose(f);
+    if (b->count == 0) {
+        fprintf(stderr, "%s: nessun campione\n", path);
+        return 0;
+    }
+    // Caso peggiore: un blocco per campione
+    b->blocks = malloc((size_t)b->count * CODEC_BLOCK_SIZE);
+    return 1;
+}
+
+// Stessa sequenza di datalog_poll()/write_block(): quando il blocco è pieno
+// si passa alla pagina successiva
+static void encode(bench_trace_t *b) {
+    codec_block_t block;
+    uint32_t seq = 0;
+
+    b->num_blocks = 0;
+    b->encoded = 0;
+    codec_block_init(&block, seq);
+    for (int i = 0; i < b->count; i++) {
+        if (!codec_block_add(&block, b->samples[i].lux, b->samples[i].time)) {
+            memcpy(b->blocks[b->num_blocks++], block.buf, block.length);
+            b->encoded += block.length;
+            codec_block_init(&block, ++seq);
+            codec_block_add(&block, b->samples[i].lux, b->samples[i].time);
+        }
+    }
+    if (block.count) {
+        memcpy(b->blocks[b->num_blocks++], block.buf, block.length);
+        b->encoded += block.length;
+    }
+}
+
+// Ritorna i campioni decodificati, -1 se un blocco è corrotto
+static int decode(const bench_trace_t *b, lux_record_t *out) {
+    int n = 0;
+
+    for (int i = 0; i < b->num_blocks; i++) {
+        int count = codec_block_decode(b->blocks[i], out + n, b->count - n);
+        if (count < 0)
+            return -1;
+        n += count;
+    }
+    return n;
+}
+
+static void print_rate(const char *what, const bench_trace_t *b, unsigned long runs, uint64_t elapsed) {
+    double seconds = elapsed / 1e9;
+    double samples = (double)b->count * runs;
+
+    printf("  %-13s %7.1f MB/s grezzi, %6.1f MB/s codificati, %6.1f M campioni/s\n", what,
+           samples * RAW_SAMPLE_BYTES / seconds / 1e6, (double)b->encoded * runs / seconds / 1e6,
+           samples / seconds / 1e6);
+}
+
+static int bench(const char *path) {
+    bench_trace_t b;
+    uint64_t start, elapsed;
+    unsigned long runs;
+    volatile int sink = 0;
+
+    if (!load_trace(path, &b))
+        return 1;
+    lux_record_t *out = malloc(b.count * sizeof(lux_record_t));
+
+    // Correttezza: giro completo senza perdite
+    encode(&b);
+    int n = decode(&b, out);
+    int lossless = n == b.count;
+    for (int i = 0; lossless && i < n; i++) {
+        lossless = out[i].lux == b.samples[i].lux && out[i].time == b.samples[i].time;
+        if (!lossless)
+            fprintf(stderr, "%s: campione %d decodificato %u lux a %u ms, atteso %u lux a %u ms\n", path, i,
+                    out[i].lux, out[i].time, b.samples[i].lux, b.samples[i].time);
+    }
+
+    unsigned long raw = (unsigned long)b.count * RAW_SAMPLE_BYTES;
+    unsigned long pages = (unsigned long)b.num_blocks * CODEC_BLOCK_SIZE;
+    printf("%s: %d campioni in %u s, %d blocchi, giro %s\n", path, b.count,
+           (b.samples[b.count - 1].time - b.samples[0].time) / 1000, b.num_blocks,
+           lossless ? "senza perdite" : "ERRATO");
+    printf("  byte grezzi %lu, codificati %lu (rapporto %.2f, %.2f byte/campione), pagine flash %lu (rapporto %.2f)\n",
+           raw, b.encoded, (double)raw / b.encoded, (double)b.encoded / b.count, pages, (double)raw / pages);
+
+    // Throughput: giri completi della traccia per BENCH_MS
+    runs = 0;
+    start = now_ns();
+    do {
+        encode(&b);
+        runs++;
+    } while ((elapsed = now_ns() - start) < BENCH_MS * 1000000ULL);
+    print_rate("codifica", &b, runs, elapsed);
+
+    runs = 0;
+    start = now_ns();
+    do {
+        sink += decode(&b, out);
+        runs++;
+    } while ((elapsed = now_ns() - start) < BENCH_MS * 1000000ULL);
+    print_rate("decodifica", &b, runs, elapsed);
+
+    free(out);
+    free(b.blocks);
+    free(b.samples);
+    return !lossless;
+}
+
+int main(int argc, char **argv) {
+    int failed = 0;
+
+    if (argc < 2) {
+        fprintf(stderr, "Uso: bench_codec traccia.csv...\n");
+        return 2;
+    }
+    for (int i = 1; i < argc; i++)
+        failed |= bench(argv[i]);
+    return failed;
+}
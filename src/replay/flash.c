@@ -0,0 +1,448 @@
+/*
+ * File:   flash.c
+ *
+ * Flash SPI simulata al livello dei singoli byte su SPI1: nel replay
+ * girano il driver vero (spi.c) e il riconoscimento JEDEC/SFDP (sfdp.c).
+ * Si può scegliere fra parti diverse; le tabelle SFDP vengono generate
+ * dai parametri dei datasheet secondo JESD216. Ogni byte trasferito
+ * avanza il tempo virtuale, quindi anche il polling del bit BUSY dura
+ * quanto sulla scheda.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <p32xxxx.h>
+
+#include "hal.h"
+#include "spi.h"
+#include "drv.h"
+
+#define SPI_BYTE_US     13      // 8 bit a 625 kHz
+#define SPI_IDLE        0xFFFFFFFF  // nessun byte da trasmettere in SPI1BUF
+#define SFDP_SIZE       0x80
+#define SR_BP           0x3C        // con un bit BP a 1 il modello protegge tutta la memoria
+#define SR_AAI          0x40        // SST25: sequenza AAI in corso
+#define WRSR_US         10000
+#define BFPT_ADDR       0x30
+
+typedef struct {
+    uint8_t exponent;   // dimensione 2^N byte, 0 = tipo assente
+    uint8_t opcode;
+    uint16_t typ_ms;
+} erase_type_t;
+
+typedef struct {
+    const char *name;
+    const char *description;
+    uint32_t id;
+    int bfpt_dwords;            // 0 = senza SFDP
+    uint16_t page_size;
+    erase_type_t erase[4];
+    uint8_t erase_multiplier;   // massimo = 2 * (M + 1) * tipico
+    uint16_t program_typ_us;
+    uint8_t program_multiplier;
+    uint32_t chip_erase_typ_ms;
+    uint8_t status;             // bit BP all'accensione
+} sim_part_t;
+
+static const sim_part_t parts[] = {
+    { "s25fl132k", "Spansion S25FL132K (Basys MX3), SFDP 1.0", 0x014016, 9, 256,
+      { { 12, 0x20, 45 }, { 16, 0xD8, 450 } }, 0, 700, 0, 20000 },
+    { "w25q32", "Winbond W25Q32JV, SFDP 1.5", 0xEF4016, 16, 256,
+      { { 12, 0x20, 45 }, { 15, 0x52, 120 }, { 16, 0xD8, 150 } }, 3, 400, 3, 10000 },
+    { "mx25l3233f", "Macronix MX25L3233F, SFDP 1.6", 0xC22016, 16, 256,
+      { { 12, 0x20, 40 }, { 15, 0x52, 200 }, { 16, 0xD8, 400 } }, 3, 500, 5, 25000 },
+    { "sst25vf016b", "SST25VF016B, senza SFDP, AAI, protetta all'accensione", 0xBF2541, 0, 1,
+      { { 12, 0x20, 18 }, { 15, 0x52, 18 }, { 16, 0xD8, 18 } }, 0, 10, 0, 35, 0x1C },
+    { "w25q32-bp", "Winbond W25Q32JV con i bit BP lasciati a 1", 0xEF4016, 16, 256,
+      { { 12, 0x20, 45 }, { 15, 0x52, 120 }, { 16, 0xD8, 150 } }, 3, 400, 3, 10000, 0x1C },
+    { "m25p32", "ST M25P32, senza SFDP, solo settori da 64KB", 0x202016, 0, 256,
+      { { 16, 0xD8, 600 } }, 0, 800, 0, 23000 },
+    { "none", "nessuna flash collegata (MISO alto)", 0xFFFFFF, 0, 256,
+      { { 0 } }, 0, 0, 0, 0 },
+};
+
+#define NUM_PARTS (sizeof(parts) / sizeof(parts[0]))
+
+volatile replay_TRISFbits_t TRISFbits;
+volatile replay_SPI1CONbits_t SPI1CONbits;
+volatile unsigned int SPI1CON, SPI1BRG, RPF2R, SDI1R;
+
+uint8_t flash_image[FLASH_IMAGE_SIZE];
+
+static const sim_part_t *part = &parts[0];
+static uint8_t sfdp[SFDP_SIZE];
+
+// Registri simulati
+static volatile replay_LATFbits_t latf = { 1 };
+static volatile unsigned int spi_buf = SPI_IDLE;
+static int responded = 0;   // risposta pronta in spi_buf, non ancora letta
+static int consumed = 0;    // spi_buf contiene una risposta già letta
+
+// Stato della memoria
+static int in_frame = 0;
+static int frame_busy = 0;  // comando iniziato durante una programmazione
+static uint8_t cmd;
+static int pos;
+static uint32_t addr;
+static int wel = 0;
+static uint64_t busy_until = 0;
+static uint8_t program_data[256];
+static int program_length;
+static uint8_t status_reg;  // bit BP
+static int ewsr = 0;        // SST25: scrittura dello status register abilitata
+static int aai = 0;         // SST25: indirizzo della prossima parola AAI valido
+static uint32_t aai_start, aai_addr;
+
+// ---------------------------------------------------------------- SFDP
+
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+// Tempo tipico come conteggio a 5 bit + unità (la più piccola che basta)
+static uint32_t encode_time(uint32_t typ, const uint32_t *units) {
+    for (uint32_t u = 0; u < 4; u++) {
+        uint32_t count = (typ + units[u] - 1) / units[u];
+        if (count <= 32)
+            return (count ? count - 1 : 0) | (u << 5);
+    }
+    return 0x1F | (3 << 5);
+}
+
+static void build_sfdp(void) {
+    static const uint32_t erase_units[] = { 1, 16, 128, 1000 };
+    static const uint32_t chip_units[] = { 16, 256, 4000, 64000 };
+    uint32_t dw[16] = { 0 };
+    int minor = part->bfpt_dwords > 9 ? 6 : 0;
+
+    memset(sfdp, 0xFF, sizeof(sfdp));
+    if (!part->bfpt_dwords)
+        return; // il comando 0x5A viene ignorato, MISO resta alto
+
+    memcpy(sfdp, "SFDP", 4);
+    sfdp[4] = minor;
+    sfdp[5] = 1;
+    sfdp[6] = 0;        // un solo parameter header
+    sfdp[7] = 0xFF;
+    sfdp[8] = 0x00;     // ID 0xFF00: tabella di base JEDEC
+    sfdp[9] = minor;
+    sfdp[10] = 1;
+    sfdp[11] = part->bfpt_dwords;
+    sfdp[12] = BFPT_ADDR;
+    sfdp[13] = 0;
+    sfdp[14] = 0;
+    sfdp[15] = 0xFF;
+
+    // DWORD 1: cancellazione da 4KB, solo indirizzi a 3 byte
+    dw[0] = 0xFF800000 | (0xFF << 8) | 0x03;
+    for (int t = 0; t < 4; t++) {
+        if (part->erase[t].exponent == 12)
+            dw[0] = 0xFF800000 | (part->erase[t].opcode << 8) | 0x01;
+    }
+    // DWORD 2: densità in bit - 1
+    dw[1] = (1UL << JEDEC_CAPACITY(part->id)) * 8 - 1;
+    // DWORD 8-9: tipi di cancellazione
+    for (int t = 0; t < 4; t++) {
+        uint32_t field = part->erase[t].exponent | (part->erase[t].opcode << 8);
+        if (!part->erase[t].exponent)
+            field = 0;
+        dw[7 + t / 2] |= field << (16 * (t % 2));
+    }
+    // DWORD 10: tempi di cancellazione
+    dw[9] = part->erase_multiplier;
+    for (int t = 0; t < 4; t++) {
+        if (part->erase[t].exponent)
+            dw[9] |= encode_time(part->erase[t].typ_ms, erase_units) << (4 + 7 * t);
+    }
+    // DWORD 11: pagina, programmazione, chip erase
+    int page_exponent = 0;
+    while ((1 << page_exponent) < part->page_size)
+        page_exponent++;
+    uint32_t unit_us = part->program_typ_us > 8 * 32 ? 64 : 8;
+    uint32_t count = (part->program_typ_us + unit_us - 1) / unit_us;
+    dw[10] = part->program_multiplier | (page_exponent << 4) | ((count ? count - 1 : 0) << 8)
+             | (unit_us == 64 ? 0x2000 : 0);
+    uint32_t chip = encode_time(part->chip_erase_typ_ms, chip_units);
+    dw[10] |= (chip & 0x1F) << 24 | (chip >> 5) << 29;
+
+    for (int d = 0; d < part->bfpt_dwords; d++)
+        put32(&sfdp[BFPT_ADDR + 4 * d], dw[d]);
+}
+
+int flash_sim_select(const char *name) {
+    for (unsigned int i = 0; i < NUM_PARTS; i++) {
+        if (strcmp(parts[i].name, name) == 0) {
+            part = &parts[i];
+            status_reg = part->status;
+            build_sfdp();
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void flash_sim_list(void) {
+    for (unsigned int i = 0; i < NUM_PARTS; i++)
+        fprintf(stderr, "  %-12s %s\n", parts[i].name, parts[i].description);
+}
+
+int flash_sim_check(void) {
+    uint32_t erase_size = 0;
+    uint8_t erase_opcode = 0;
+
+    for (int t = 0; t < 4; t++) {
+        uint32_t size = 1UL << part->erase[t].exponent;
+        if (part->erase[t].exponent && (!erase_size || size < erase_size)) {
+            erase_size = size;
+            erase_opcode = part->erase[t].opcode;
+        }
+    }
+    int ok = flash_geo.jedec_id == part->id;
+    if (erase_size)
+        ok = ok && flash_geo.page_size == part->page_size && flash_geo.erase_size == erase_size
+             && flash_geo.erase_opcode == erase_opcode;
+
+    replay_log("FLASH", "detect %s id %06X page %u erase %u 0x%02X read 0x%02X timeout %u/%u ms %s",
+               part->name, flash_geo.jedec_id, flash_geo.page_size, flash_geo.erase_size,
+               flash_geo.erase_opcode, FLASH_CMD_READ, flash_geo.erase_timeout_ms,
+               flash_geo.program_timeout_ms, ok ? "ok" : "DIVERSA");
+    return ok;
+}
+
+// ---------------------------------------------------------------- Memoria
+
+static uint32_t crc32(const uint8_t *data, int len) {
+    uint32_t crc = 0xFFFFFFFF;
+
+    while (len--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+    }
+    return ~crc;
+}
+
+static uint8_t read_image(uint32_t a) {
+    return a < FLASH_IMAGE_SIZE ? flash_image[a] : 0xFF;
+}
+
+// Come sulla flash vera un comando su memoria protetta viene ignorato;
+// nel log resta traccia per il confronto con i golden
+static int protected(const char *what, uint32_t a) {
+    if (!(status_reg & SR_BP))
+        return 0;
+    replay_log("FLASH", "%s 0x%06X ignorata, BP %02X", what, a, status_reg & SR_BP);
+    return 1;
+}
+
+// Come sulla NOR flash la programmazione può solo azzerare bit: una
+// scrittura senza cancellazione preventiva si vede nel CRC registrato
+static void program(void) {
+    uint32_t start = addr & ~(uint32_t)(part->page_size - 1);
+    uint32_t offset = addr & (part->page_size - 1);
+    int n = program_length < part->page_size ? program_length : part->page_size;
+
+    if (protected("write", addr))
+        return;
+    for (int i = 0; i < n; i++) {
+        uint32_t a = start + ((offset + i) & (part->page_size - 1));
+        if (a < FLASH_IMAGE_SIZE)
+            flash_image[a] &= program_data[i];
+    }
+    if (addr + n <= FLASH_IMAGE_SIZE)
+        replay_log("FLASH", "write 0x%06X %d crc %08X", addr, n, crc32(&flash_image[addr], n));
+    busy_until = vt_now_us() + part->program_typ_us;
+}
+
+static void erase(uint32_t size, uint32_t typ_ms) {
+    uint32_t start = addr & ~(size - 1);
+
+    if (protected("erase", start))
+        return;
+    if (start < FLASH_IMAGE_SIZE)
+        memset(&flash_image[start], 0xFF, start + size <= FLASH_IMAGE_SIZE ? size : FLASH_IMAGE_SIZE - start);
+    if (size == FLASH_SECTOR_SIZE)
+        replay_log("FLASH", "erase 0x%06X", start);
+    else
+        replay_log("FLASH", "erase 0x%06X %u", start, size);
+    busy_until = vt_now_us() + (uint64_t)typ_ms * 1000;
+}
+
+// SST25 AAI: una parola all'indirizzo corrente, la sequenza nel log come
+// una sola scrittura alla chiusura
+static void program_word(void) {
+    for (int i = 0; i < 2; i++) {
+        if (aai_addr + i < FLASH_IMAGE_SIZE)
+            flash_image[aai_addr + i] &= program_data[i];
+    }
+    aai_addr += 2;
+    busy_until = vt_now_us() + part->program_typ_us;
+}
+
+static void aai_end(void) {
+    uint32_t n = aai_addr - aai_start;
+
+    if (aai_addr <= FLASH_IMAGE_SIZE)
+        replay_log("FLASH", "write 0x%06X %u crc %08X aai", aai_start, n, crc32(&flash_image[aai_start], n));
+    aai = 0;
+}
+
+// Il comando viene eseguito quando CS torna alto
+static void end_frame(void) {
+    in_frame = 0;
+    if (frame_busy)
+        return; // ignorato durante una programmazione o cancellazione
+
+    switch (cmd) {
+    case 0x06:
+        wel = 1;
+        return;
+    case 0x04:
+        if (aai)
+            aai_end();
+        wel = 0;
+        return;
+    case 0x50:
+        ewsr = JEDEC_MANUFACTURER(part->id) == JEDEC_SST;
+        return;
+    case 0x01:
+        if ((wel || ewsr) && pos >= 1) {
+            status_reg = program_data[0] & SR_BP;
+            busy_until = vt_now_us() + WRSR_US;
+        }
+        wel = 0;
+        ewsr = 0;
+        return;
+    case 0xAD:
+        if (JEDEC_MANUFACTURER(part->id) != JEDEC_SST || !wel)
+            return;
+        if (!aai) {
+            // primo comando: indirizzo pari e una parola
+            if (pos < 5 || protected("write", addr)) {
+                wel = 0;
+                return;
+            }
+            aai = 1;
+            aai_start = aai_addr = addr & ~1;
+        } else if (pos < 2) {
+            return;
+        }
+        program_word();
+        return;
+    case 0x02:
+        if (wel && pos >= 4)
+            program();
+        wel = 0;
+        return;
+    case 0x60:
+    case 0xC7:
+        if (wel && !protected("erase chip", 0)) {
+            memset(flash_image, 0xFF, sizeof(flash_image));
+            replay_log("FLASH", "erase chip");
+            busy_until = vt_now_us() + (uint64_t)part->chip_erase_typ_ms * 1000;
+        }
+        wel = 0;
+        return;
+    }
+    for (int t = 0; t < 4; t++) {
+        if (part->erase[t].exponent && cmd == part->erase[t].opcode) {
+            if (wel && pos >= 3)
+                erase(1UL << part->erase[t].exponent, part->erase[t].typ_ms);
+            wel = 0;
+            return;
+        }
+    }
+}
+
+// Un byte in ciascuna direzione, MISO alto se la flash non risponde
+static uint8_t transfer(uint8_t out) {
+    if (latf.LATF8 || part->id == 0xFFFFFF)
+        return 0xFF;
+
+    if (!in_frame) {
+        in_frame = 1;
+        frame_busy = vt_now_us() < busy_until && out != 0x05;
+        cmd = out;
+        pos = 0;
+        addr = 0;
+        program_length = 0;
+        stages[STAGE_FLASH].calls++;
+        return 0xFF;
+    }
+    pos++;
+
+    if (cmd == 0x05)
+        return (vt_now_us() < busy_until) | (wel << 1) | status_reg | (aai ? SR_AAI : 0);
+    if (cmd == 0x9F)
+        return pos <= 3 ? (part->id >> (8 * (3 - pos))) & 0xFF : 0xFF;
+    if (frame_busy)
+        return 0xFF;
+    if (cmd == 0x01 || (cmd == 0xAD && aai)) {
+        // senza indirizzo: status register o parola AAI successiva
+        if (program_length < 2)
+            program_data[program_length++] = out;
+        return 0xFF;
+    }
+    if (pos <= 3) {
+        addr = (addr << 8) | out;
+        return 0xFF;
+    }
+
+    switch (cmd) {
+    case 0x03:
+        return read_image(addr + pos - 4);
+    case 0x0B:
+        return pos == 4 ? 0xFF : read_image(addr + pos - 5);
+    case 0x5A:
+        return pos == 4 || addr + pos - 5 >= SFDP_SIZE ? 0xFF : sfdp[addr + pos - 5];
+    case 0x02:
+    case 0xAD:
+        if (program_length < (int)sizeof(program_data))
+            program_data[program_length++] = out;
+        return 0xFF;
+    }
+    return 0xFF;
+}
+
+// ---------------------------------------------------------------- Registri
+
+// Ogni accesso a CS passa da qui prima della scrittura: se CS è già alto
+// il comando precedente è terminato
+volatile replay_LATFbits_t *replay_latf(void) {
+    if (in_frame && latf.LATF8)
+        end_frame();
+    return &latf;
+}
+
+// Scrittura di SPI1BUF: avvia un trasferimento; lettura: prende la risposta
+volatile unsigned int *replay_spi1_buf(void) {
+    if (responded) {
+        responded = 0;
+        consumed = 1;
+    } else {
+        consumed = 0;
+        spi_buf = SPI_IDLE;
+    }
+    return &spi_buf;
+}
+
+replay_SPI1STATbits_t replay_spi1_stat(void) {
+    replay_SPI1STATbits_t stat = { 1, 0 };
+
+    if (!responded && !consumed && spi_buf != SPI_IDLE) {
+        uint64_t start = host_ns();
+        if (in_frame && latf.LATF8)
+            end_frame();
+        spi_buf = transfer(spi_buf & 0xFF);
+        responded = 1;
+        stage_time(STAGE_FLASH, start, SPI_BYTE_US, 1);
+    } else if (!responded) {
+        vt_advance(1); // polling senza trasferimento: scadono i timeout
+    }
+    stat.SPIRBF = responded;
+    return stat;
+}
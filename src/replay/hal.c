@@ -0,0 +1,335 @@
+/*
+ * File:   hal.c
+ *
+ * Sostituti su host dei driver del firmware (Timer, UART4, LCD, clock;
+ * la flash SPI è simulata in flash.c, il bus I2C1 in i2c_sim.c). Ogni attesa attiva del
+ * firmware diventa un avanzamento del tempo virtuale pari alla durata tipica dell'operazione sul dispositivo,
+ * così la temporizzazione degli eventi segue quella della scheda.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <p32xxxx.h>
+
+#include "hal.h"
+#include "Timer.h"
+#include "Uart.h"
+#include "LCD.h"
+#include "i2c.h"
+#include "clock.h"
+#include "ADC.h"
+#include "events.h"
+#include "drv.h"
+
+// Durate tipiche sul dispositivo (us)
+#define UART_BYTE_US        1042    // 10 bit a 9600 baud
+#define LCD_CMD_US          40
+#define LCD_CLEAR_US        1640
+
+volatile unsigned int LATA;
+volatile replay_LATDbits_t LATDbits;
+volatile replay_OC1CONbits_t OC1CONbits;
+
+stage_t stages[NUM_STAGES] = {
+    { "I2C1" }, { "LCD" }, { "flash" }, { "UART" },
+};
+
+static uint64_t vt_us = 0;
+static unsigned int event_period = 0;
+static unsigned int event_count = 0;
+
+uint64_t host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+uint64_t vt_now_us(void) {
+    return vt_us;
+}
+
+// Corrisponde alla ISR del Timer1
+static void timer1_tick(void) {
+    replay_tick((unsigned int)(vt_us / 1000));
+    if (event_period && ++event_count >= event_period) {
+        event_count = 0;
+        event_push(EV_TIMER, 0);
+    }
+}
+
+void vt_advance(uint64_t us) {
+    uint64_t end = vt_us + us;
+
+    while (vt_us / 1000 < end / 1000) {
+        vt_us = (vt_us / 1000 + 1) * 1000;
+        timer1_tick();
+    }
+    vt_us = end;
+}
+
+unsigned int replay_mfc0(int reg, int sel) {
+    return (unsigned int)(vt_us * (CLOCK_BOOT_SYSCLK / 2000000));
+}
+
+// Il tempo del dispositivo avanza il tempo virtuale solo se il firmware
+// resta in attesa (blocking)
+void stage_time(int stage, uint64_t start_ns, uint64_t device_us, int blocking) {
+    stages[stage].device_us += device_us;
+    if (blocking)
+        vt_advance(device_us);
+    stages[stage].host_ns += host_ns() - start_ns;
+}
+
+// Contabilizza una chiamata
+static void stage_account(int stage, uint64_t start_ns, uint64_t device_us, int blocking) {
+    stages[stage].calls++;
+    stage_time(stage, start_ns, device_us, blocking);
+}
+
+// ---------------------------------------------------------------- Timer
+
+void Delayms(unsigned t) {
+    vt_advance((uint64_t)t * 1000);
+}
+
+// Il delay_us() di drv.c conta i tick del core timer, che nel replay
+// avanzano solo con il tempo virtuale
+void delay_us(unsigned int us) {
+    vt_advance(us);
+}
+
+void Timer2_init(void) { }
+void Timer1_init(void) { }
+void MultiVector_mode(void) { }
+
+unsigned int millis(void) {
+    return (unsigned int)(vt_us / 1000);
+}
+
+void Timer1_set_event_period(unsigned ms) {
+    event_period = ms;
+    event_count = 0;
+}
+
+// ---------------------------------------------------------------- Clock
+
+static int mode = CLOCK_MODE_NORMAL;
+
+unsigned int clock_sysclk(void) { return CLOCK_BOOT_SYSCLK; }
+unsigned int clock_pbclk(void) { return CLOCK_BOOT_PBCLK; }
+int clock_mode(void) { return mode; }
+
+// Il replay simula solo la configurazione di avvio
+int clock_set_mode(int m) {
+    mode = m;
+    return DRV_OK;
+}
+
+void clock_report(void) {
+    UART4_WriteString("Clock: nel replay solo configurazione di avvio (40/20 MHz)\r\n");
+}
+
+// ---------------------------------------------------------------- UART4
+
+static char uart_line[256];
+static int uart_line_length = 0;
+static unsigned long uart_total = 0;
+static uint64_t tx_end_us = 0; // fine della trasmissione a interrupt in corso
+
+unsigned long uart_bytes(void) {
+    return uart_total;
+}
+
+// Ogni riga trasmessa diventa una voce del log
+static void uart_capture(char c) {
+    uart_total++;
+    if (c == '\n') {
+        uart_line[uart_line_length] = '\0';
+        replay_log("UART", "\"%s\"", uart_line);
+        uart_line_length = 0;
+    } else if (c != '\r' && uart_line_length < (int)sizeof(uart_line) - 5) {
+        if (c >= 0x20 && c < 0x7F && c != '"' && c != '\\')
+            uart_line[uart_line_length++] = c;
+        else
+            uart_line_length += sprintf(&uart_line[uart_line_length], "\\x%02X", (unsigned char)c);
+    }
+}
+
+int UART4_TxBusy(void) {
+    return vt_us < tx_end_us;
+}
+
+int UART4_WaitIdle(void) {
+    if (vt_us < tx_end_us)
+        vt_advance(tx_end_us - vt_us);
+    return DRV_OK;
+}
+
+int putU4(char c) {
+    uint64_t start = host_ns();
+    UART4_WaitIdle();
+    uart_capture(c);
+    stage_account(STAGE_UART, start, UART_BYTE_US, 1);
+    return DRV_OK;
+}
+
+void UART4_WriteString(const char *str) {
+    uint64_t start = host_ns();
+    int n = 0;
+
+    UART4_WaitIdle();
+    for (; str[n]; n++)
+        uart_capture(str[n]);
+    stage_account(STAGE_UART, start, (uint64_t)n * UART_BYTE_US, 1);
+}
+
+// Trasmissione a interrupt: il main loop prosegue, il trasmettitore
+// resta occupato per la durata del buffer
+int UART4_StartTx(const char *buf, int len) {
+    uint64_t start = host_ns();
+
+    UART4_WaitIdle();
+    for (int i = 0; i < len; i++)
+        uart_capture(buf[i]);
+    tx_end_us = vt_us + (uint64_t)len * UART_BYTE_US;
+    stage_account(STAGE_UART, start, (uint64_t)len * UART_BYTE_US, 0);
+    return DRV_OK;
+}
+
+void UART_ConfigurePins(void) { }
+void UART_ConfigureUart(void) { }
+void UART4_set_baud(unsigned int baud) { (void)baud; }
+void UART4_EnableRxInterrupt(void) { }
+
+// ---------------------------------------------------------------- LCD
+
+// DDRAM del controller HD44780: riga 1 da 0x00, riga 2 da 0x40.
+// CGRAM: 8 glifi da 8 righe, mostrati ai codici 0-7 e 8-15
+static char ddram[0x68] = { [0 ... 0x67] = ' ' };
+static unsigned char cgram[64];
+static int lcd_addr = 0;
+static int lcd_cgram = 0; // il contatore di indirizzo punta alla CGRAM
+
+// Nel log i glifi della CGRAM diventano 'a'-'h' e la cella piena '#'
+static void lcd_line(char *out, const char *in) {
+    for (int i = 0; i < HLCD; i++) {
+        unsigned char c = (unsigned char)in[i];
+        out[i] = c < 0x10 ? 'a' + (c & 7) : c == 0xFF ? '#' : (char)c;
+    }
+    out[HLCD] = '\0';
+}
+
+void lcd_frame(char line1[17], char line2[17]) {
+    lcd_line(line1, &ddram[0x00]);
+    lcd_line(line2, &ddram[0x40]);
+}
+
+void lcd_glyphs(unsigned char out[64]) {
+    memcpy(out, cgram, sizeof(cgram));
+}
+
+int initLCD_step(void) {
+    memset(ddram, ' ', sizeof(ddram));
+    lcd_addr = 0;
+    lcd_cgram = 0;
+    return 1;
+}
+
+char readLCD(int addr) {
+    return addr == LCDCMD ? (char)lcd_addr : ddram[lcd_addr];
+}
+
+int writeLCD(int addr, char c) {
+    uint64_t start = host_ns();
+    uint64_t cost = LCD_CMD_US;
+    unsigned char v = (unsigned char)c;
+
+    if (addr == LCDDATA && lcd_cgram) {
+        cgram[lcd_addr] = v & 0x1F;
+        lcd_addr = (lcd_addr + 1) % (int)sizeof(cgram);
+    } else if (addr == LCDDATA) {
+        ddram[lcd_addr] = c;
+        lcd_addr = (lcd_addr + 1) % (int)sizeof(ddram);
+    } else if (v & 0x80) {
+        lcd_addr = (v & 0x7F) % (int)sizeof(ddram);
+        lcd_cgram = 0;
+    } else if (v & 0x40) {
+        lcd_addr = v & 0x3F;
+        lcd_cgram = 1;
+    } else if (v == 0x01) {
+        memset(ddram, ' ', sizeof(ddram));
+        lcd_addr = 0;
+        lcd_cgram = 0;
+        cost = LCD_CLEAR_US;
+    } else if (v == 0x02) {
+        lcd_addr = 0;
+        lcd_cgram = 0;
+        cost = LCD_CLEAR_US;
+    }
+    stage_account(STAGE_LCD, start, cost, 1);
+    return DRV_OK;
+}
+
+int putsLCD(char *s) {
+    while (*s) {
+        int status = writeLCD(LCDDATA, *s++);
+        if (status != DRV_OK)
+            return status;
+    }
+    return DRV_OK;
+}
+
+// ---------------------------------------------------------------- Altro
+
+// Lo stack dell'host non dice nulla di quello del PIC32
+void mem_paint_stack(void) { }
+
+void mem_report(void) {
+    UART4_WriteString("Memoria: non disponibile nel replay\r\n");
+}
+
+void Init_pins(void) { }
+void BTNC_Interrupt_Init(void) { }
+void audio_init(void) { }
+void init_ADC(void) { }
+
+// ---------------------------------------------------------------- ADC
+
+// AN2 vede una lampada sulla rete a 50 Hz: raddrizzata a doppia semionda,
+// flicker a 100 Hz con armoniche, più qualche conteggio di rumore.
+// La finestra si riempie quando il tempo virtuale ne raggiunge la fine
+static volatile int16_t *adc_buf;
+static int adc_length = 0;
+static unsigned int adc_hz;
+static uint64_t adc_start_us;
+static int adc_ready = 0;
+static uint32_t adc_noise = 1;
+
+void adc_fast_start(volatile int16_t *buf, int n, unsigned int hz) {
+    adc_buf = buf;
+    adc_length = n;
+    adc_hz = hz;
+    adc_start_us = vt_us;
+    adc_ready = 0;
+}
+
+int adc_fast_done(void) {
+    if (adc_ready || !adc_length)
+        return adc_ready;
+    if (vt_us < adc_start_us + (uint64_t)adc_length * 1000000 / adc_hz)
+        return 0;
+    for (int i = 0; i < adc_length; i++) {
+        double t = adc_start_us / 1e6 + (double)i / adc_hz;
+        adc_noise = adc_noise * 1103515245 + 12345;
+        adc_buf[i] = (int16_t)(420 + 260 * fabs(sin(2 * M_PI * 50 * t)) + (int)(adc_noise >> 16) % 7 - 3);
+    }
+    adc_ready = 1;
+    return 1;
+}
+
+void adc_fast_stop(void) {
+    adc_length = 0;
+    adc_ready = 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * File:   hal.h
+ *
+ * Hardware simulato per il replay: tempo virtuale, costi dei bus e
+ * cattura delle uscite (LED, LCD, UART, flash).
+ */
+
+#ifndef REPLAY_HAL_H
+#define REPLAY_HAL_H
+
+#include <stdint.h>
+
+// Stadi della pipeline misurati nel rapporto finale
+#define STAGE_SENSOR    0   // traffico I2C1 (TSL2561 e accelerometro)
+#define STAGE_LCD       1
+#define STAGE_FLASH     2
+#define STAGE_UART      3
+#define NUM_STAGES      4
+
+typedef struct {
+    const char *name;
+    unsigned long calls;
+    uint64_t device_us; // tempo di bus/dispositivo simulato
+    uint64_t host_ns;   // tempo reale speso nello stub
+} stage_t;
+
+extern stage_t stages[NUM_STAGES];
+
+// Dimensione dell'immagine della flash (copre LOG_END_ADDR)
+#define FLASH_IMAGE_SIZE 0x200000
+extern uint8_t flash_image[FLASH_IMAGE_SIZE];
+
+// Aggiunge tempo di dispositivo e di host a uno stadio
+void stage_time(int stage, uint64_t start_ns, uint64_t device_us, int blocking);
+
+// Tempo virtuale in microsecondi dal reset
+uint64_t vt_now_us(void);
+
+// Fa avanzare il tempo virtuale, eseguendo un tick del Timer1 per ogni
+// millisecondo attraversato
+void vt_advance(uint64_t us);
+
+// Tempo reale dell'host in ns (per il rapporto sulle prestazioni)
+uint64_t host_ns(void);
+
+// Implementate in replay.c
+void replay_tick(unsigned int ms);                  // ingressi programmati
+void replay_sensor(uint16_t *ch0, uint16_t *ch1);   // campione della traccia
+void replay_accel(int16_t xyz[3]);                  // accelerometro, conteggi
+void replay_log(const char *kind, const char *fmt, ...);
+
+// Flash simulata (flash.c): sceglie la parte collegata, 0 se sconosciuta
+int flash_sim_select(const char *name);
+void flash_sim_list(void);
+// Confronta la geometria rilevata dal firmware con quella della parte
+// simulata e la registra nel log; ritorna 1 se coincide
+int flash_sim_check(void);
+
+// Slave simulati sul bus I2C1 (i2c_sim.c)
+#define SENSOR_I2C_ADDR     0x29
+#define SENSOR_ID           0x50    // TSL2561, revisione 0
+#define ACCEL_ID            0x4A    // MMA8652, all'indirizzo SLAVE_ADDR
+
+// Guasto iniettato sul bus, resta attivo fino alla chiamata successiva
+#define I2C_FAULT_NONE  0
+#define I2C_FAULT_NACK  1   // nessuno slave risponde al proprio indirizzo
+#define I2C_FAULT_SDA   2   // a ogni START uno slave tiene SDA basso per alcuni clock
+#define I2C_FAULT_SCL   3   // uno slave tiene SCL basso (stretching senza fine)
+#define I2C_FAULT_BCL   4   // un altro master occupa il bus allo START
+
+typedef struct {
+    unsigned long collisions;   // START non generati (BCL)
+    unsigned long nacks;        // indirizzi senza risposta
+    unsigned long clocks;       // fronti di SCL del bus recovery verso uno slave bloccato
+    unsigned long reads;        // letture iniziate da uno slave
+} i2c_sim_stats_t;
+
+void i2c_sim_fault(int fault);
+i2c_sim_stats_t i2c_sim_stats(void);
+
+// Prova dei guasti I2C1 (i2c_faults.c, opzione -i): chiamate dirette al
+// driver dopo app_init(), poi un guasto per finestra durante il replay.
+// Le funzioni che controllano ritornano il numero di controlli falliti
+int i2c_faults_direct(void);
+void i2c_faults_step(uint64_t step_start_us);
+int i2c_faults_report(void);
+
+// Stato corrente di LCD e UART
+void lcd_frame(char line1[17], char line2[17]);
+void lcd_glyphs(unsigned char out[64]);
+unsigned long uart_bytes(void);
+
+#endif // REPLAY_HAL_H
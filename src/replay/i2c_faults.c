@@ -0,0 +1,217 @@
+/*
+ * File:   i2c_faults.c
+ *
+ * Prova del driver I2C1 (i2c.c) sui guasti del bus simulato, opzione -i
+ * del replay. Le chiamate dirette controllano per ogni guasto il codice di
+ * stato, gli incrementi dei contatori di drv.h, la durata della
+ * transazione e che dopo il guasto il bus torni a funzionare. Durante il
+ * replay ogni guasto resta poi attivo per FAULT_WINDOW_MS: il main loop
+ * deve continuare a girare con passi brevi e le letture del TSL2561
+ * devono riprendere alla fine della finestra.
+ */
+
+#include <stdio.h>
+#include <p32xxxx.h>
+
+#include "hal.h"
+#include "i2c.h"
+#include "accel.h"
+#include "drv.h"
+
+#define SENSOR_CMD_ID       0xAA    // comando del TSL2561 + registro ID
+
+#define CALL_MAX_US         (2 * I2C_TIMEOUT_US)
+#define FAULT_WINDOW_MS     1000
+#define FAULT_GAP_MS        1000    // senza guasti fra due finestre
+#define FAULT_FIRST_MS      2000
+// Con il bus guasto un passo del main loop fa al massimo tre transazioni
+// (due canali del TSL2561 e l'accelerometro), ognuna limitata da un
+// timeout e da un bus recovery; senza campioni nuovi LCD e log sono fermi
+#define LOOP_MAX_US         (3 * CALL_MAX_US)
+
+typedef struct {
+    const char *name;
+    int fault;
+    int write;          // 1: scrittura all'accelerometro, 0: ID del TSL2561
+    int status;
+    drv_stats_t delta;  // incrementi attesi di i2c1_stats
+} fault_case_t;
+
+static const fault_case_t cases[] = {
+    { "nessuno", I2C_FAULT_NONE, 0, DRV_OK,        { 0, 0, 0, 0 } },
+    { "NACK",    I2C_FAULT_NACK, 0, DRV_NACK,      { 0, 1, 0, 0 } },
+    { "NACK",    I2C_FAULT_NACK, 1, DRV_NACK,      { 0, 1, 0, 0 } },
+    { "SDA",     I2C_FAULT_SDA,  0, DRV_BUS_ERROR, { 0, 0, 1, 1 } },
+    { "SDA",     I2C_FAULT_SDA,  1, DRV_BUS_ERROR, { 0, 0, 1, 1 } },
+    { "SCL",     I2C_FAULT_SCL,  0, DRV_TIMEOUT,   { 1, 0, 0, 1 } },
+    { "SCL",     I2C_FAULT_SCL,  1, DRV_TIMEOUT,   { 1, 0, 0, 1 } },
+    { "BCL",     I2C_FAULT_BCL,  0, DRV_BUS_ERROR, { 0, 0, 1, 1 } },
+    { "BCL",     I2C_FAULT_BCL,  1, DRV_BUS_ERROR, { 0, 0, 1, 1 } },
+};
+
+#define NUM_CASES (sizeof(cases) / sizeof(cases[0]))
+
+typedef struct {
+    const char *name;
+    int fault;
+} fault_window_t;
+
+static const fault_window_t windows[] = {
+    { "NACK", I2C_FAULT_NACK },
+    { "SDA", I2C_FAULT_SDA },
+    { "SCL", I2C_FAULT_SCL },
+    { "BCL", I2C_FAULT_BCL },
+};
+
+#define NUM_WINDOWS (sizeof(windows) / sizeof(windows[0]))
+
+typedef struct {
+    int started;
+    int ended;
+    drv_stats_t before;
+    drv_stats_t delta;
+    unsigned long reads_start;  // letture iniziate dagli slave (i2c_sim_stats)
+    unsigned long reads_end;
+    uint64_t loop_max_us;
+} window_result_t;
+
+static window_result_t results[NUM_WINDOWS];
+static int current = -1;    // finestra attiva, -1 nessuna
+static int checked = 0;     // controlli eseguiti
+
+static drv_stats_t stats_delta(drv_stats_t before, drv_stats_t after) {
+    drv_stats_t d = {
+        after.timeouts - before.timeouts, after.nacks - before.nacks,
+        after.bus_errors - before.bus_errors, after.recoveries - before.recoveries,
+    };
+    return d;
+}
+
+static int stats_equal(drv_stats_t a, drv_stats_t b) {
+    return a.timeouts == b.timeouts && a.nacks == b.nacks && a.bus_errors == b.bus_errors
+           && a.recoveries == b.recoveries;
+}
+
+static void print_delta(drv_stats_t d) {
+    fprintf(stderr, "timeout +%u nack +%u bus +%u recovery +%u",
+            d.timeouts, d.nacks, d.bus_errors, d.recoveries);
+}
+
+// Una lettura riuscita deve anche ritornare l'ID giusto
+static int transaction(int write) {
+    unsigned char value = ACCEL_CTRL_ODR_50HZ | ACCEL_CTRL_ACTIVE;
+    int status;
+
+    if (write)
+        return i2c_write(SLAVE_ADDR, ACCEL_REG_CTRL_REG1, &value, 1);
+    status = i2c_read(SENSOR_I2C_ADDR, SENSOR_CMD_ID, &value, 1);
+    return status == DRV_OK && value != SENSOR_ID ? DRV_INVALID : status;
+}
+
+int i2c_faults_direct(void) {
+    int failed = 0;
+
+    fprintf(stderr, "Guasti I2C1, chiamate dirette al driver:\n");
+    for (unsigned int i = 0; i < NUM_CASES; i++) {
+        const fault_case_t *c = &cases[i];
+        drv_stats_t before = i2c1_stats;
+        i2c_sim_stats_t sim = i2c_sim_stats();
+
+        i2c_sim_fault(c->fault);
+        uint64_t start = vt_now_us();
+        int status = transaction(c->write);
+        uint64_t us = vt_now_us() - start;
+        drv_stats_t delta = stats_delta(before, i2c1_stats);
+        i2c_sim_fault(I2C_FAULT_NONE);
+
+        // SDA: il bus recovery deve aver dato i clock allo slave bloccato
+        int clocked = c->fault != I2C_FAULT_SDA || i2c_sim_stats().clocks > sim.clocks;
+        // dopo il guasto una lettura deve tornare a funzionare
+        int recovered = transaction(0) == DRV_OK;
+        int ok = status == c->status && stats_equal(delta, c->delta) && us <= CALL_MAX_US
+                 && clocked && recovered;
+
+        fprintf(stderr, "  %-8s %-9s stato %2d (atteso %2d), ", c->name, c->write ? "scrittura" : "lettura",
+                status, c->status);
+        print_delta(delta);
+        fprintf(stderr, ", %4llu us, bus %s  %s\n", (unsigned long long)us,
+                recovered ? "ripristinato" : "BLOCCATO", ok ? "ok" : "ERRORE");
+        checked++;
+        failed += !ok;
+    }
+    return failed;
+}
+
+// Le finestre si susseguono da FAULT_FIRST_MS, una ogni
+// FAULT_WINDOW_MS + FAULT_GAP_MS
+void i2c_faults_step(uint64_t step_start_us) {
+    uint64_t now_ms = vt_now_us() / 1000;
+    uint64_t loop_us = vt_now_us() - step_start_us;
+
+    if (current >= 0 && loop_us > results[current].loop_max_us)
+        results[current].loop_max_us = loop_us;
+
+    int w = -1;
+    if (now_ms >= FAULT_FIRST_MS) {
+        uint64_t slot = (now_ms - FAULT_FIRST_MS) / (FAULT_WINDOW_MS + FAULT_GAP_MS);
+        uint64_t offset = (now_ms - FAULT_FIRST_MS) % (FAULT_WINDOW_MS + FAULT_GAP_MS);
+        if (slot < NUM_WINDOWS && offset < FAULT_WINDOW_MS)
+            w = (int)slot;
+    }
+    if (w == current)
+        return;
+
+    if (current >= 0) {
+        window_result_t *r = &results[current];
+        r->delta = stats_delta(r->before, i2c1_stats);
+        r->reads_end = i2c_sim_stats().reads;
+        r->ended = 1;
+        i2c_sim_fault(I2C_FAULT_NONE);
+    }
+    current = w;
+    if (current >= 0) {
+        results[current].started = 1;
+        results[current].before = i2c1_stats;
+        results[current].reads_start = i2c_sim_stats().reads;
+        i2c_sim_fault(windows[current].fault);
+    }
+}
+
+int i2c_faults_report(void) {
+    unsigned long reads = i2c_sim_stats().reads;
+    int failed = 0;
+
+    fprintf(stderr, "Guasti I2C1 nel main loop, finestre da %d ms:\n", FAULT_WINDOW_MS);
+    for (unsigned int i = 0; i < NUM_WINDOWS; i++) {
+        window_result_t *r = &results[i];
+        const drv_stats_t *d = &r->delta;
+        int counted;
+
+        switch (windows[i].fault) {
+        case I2C_FAULT_NACK:
+            counted = d->nacks > 0 && d->recoveries == 0;
+            break;
+        case I2C_FAULT_SCL:
+            counted = d->timeouts > 0 && d->recoveries > 0;
+            break;
+        default:
+            counted = d->bus_errors > 0 && d->recoveries > 0;
+            break;
+        }
+        // letture riprese prima della finestra successiva o della fine
+        unsigned long next = i + 1 < NUM_WINDOWS && results[i + 1].started ? results[i + 1].reads_start : reads;
+        int resumed = r->ended && next > r->reads_end;
+        int ok = r->ended && counted && r->loop_max_us <= LOOP_MAX_US && resumed;
+
+        fprintf(stderr, "  %-8s %5u ms: ", windows[i].name,
+                FAULT_FIRST_MS + i * (FAULT_WINDOW_MS + FAULT_GAP_MS));
+        print_delta(r->delta);
+        fprintf(stderr, ", latenza max %llu us (limite %d), letture %s  %s\n",
+                (unsigned long long)r->loop_max_us, LOOP_MAX_US, resumed ? "riprese" : "FERME",
+                ok ? "ok" : "ERRORE");
+        checked++;
+        failed += !ok;
+    }
+    fprintf(stderr, "Guasti I2C1: %d controlli, %d falliti\n", checked, failed);
+    return failed;
+}
@@ -0,0 +1,281 @@
+/*
+ * File:   i2c_sim.c
+ *
+ * Modulo I2C1 del PIC32 e slave del bus simulati al livello dei registri:
+ * nel replay gira il driver vero (i2c.c), con le sue attese, i timeout e
+ * il bus recovery. Ogni operazione richiesta con I2C1CON o I2C1TRN viene
+ * eseguita all'accesso successivo a un registro del bus e avanza il tempo
+ * virtuale della sua durata sul bus a 100 kHz. Con i2c_sim_fault() si
+ * iniettano i guasti: NACK, SDA bloccato, SCL bloccato e collisione.
+ */
+
+#include <string.h>
+#include <p32xxxx.h>
+
+#include "hal.h"
+#include "i2c.h"
+
+#define I2C_BYTE_US         90      // 8 bit e ACK a 100 kHz
+#define I2C_RECV_US         80      // 8 bit, l'ACK lo manda il master
+#define I2C_BIT_US          10      // start, restart, stop e ACK del master
+#define I2C_SDA_CLOCKS      7       // clock perché uno slave bloccato rilasci SDA
+
+enum { BUS_IDLE, BUS_ADDRESS, BUS_WRITE, BUS_READ };
+
+typedef struct {
+    uint8_t addr;
+    uint8_t cmd_mask;       // bit del primo byte scritto che indicano il registro
+    uint8_t size;           // registri, il puntatore ricomincia da 0
+    void (*load)(uint8_t *regs);
+} sim_slave_t;
+
+// TSL2561: il campione della traccia valido all'istante della lettura
+static void sensor_load(uint8_t *regs) {
+    uint16_t ch0, ch1;
+
+    replay_sensor(&ch0, &ch1);
+    regs[0x0A] = SENSOR_ID;
+    regs[0x0C] = ch0 & 0xFF;
+    regs[0x0D] = ch0 >> 8;
+    regs[0x0E] = ch1 & 0xFF;
+    regs[0x0F] = ch1 >> 8;
+}
+
+// Accelerometro: WHO_AM_I e X, Y, Z (12 bit allineati a sinistra, MSB
+// prima) da replay_accel()
+static void accel_load(uint8_t *regs) {
+    int16_t xyz[3];
+
+    replay_accel(xyz);
+    regs[0x00] = 0x0F; // ZYXDR e i tre bit dei singoli assi
+    for (int i = 0; i < 3; i++) {
+        regs[1 + 2 * i] = (uint16_t)(xyz[i] << 4) >> 8;
+        regs[2 + 2 * i] = (uint16_t)(xyz[i] << 4) & 0xF0;
+    }
+    regs[0x0D] = ACCEL_ID;
+}
+
+static const sim_slave_t slaves[] = {
+    { SENSOR_I2C_ADDR, 0x0F, 0x10, sensor_load },
+    { SLAVE_ADDR, 0xFF, 0x30, accel_load },
+};
+
+#define NUM_SLAVES (sizeof(slaves) / sizeof(slaves[0]))
+
+volatile unsigned int I2C1BRG;
+volatile replay_LATGbits_t LATGbits;
+
+// Registri simulati
+static volatile replay_I2C1CON_t con;
+static volatile replay_I2C1STATbits_t stat;
+static volatile unsigned int trn;
+static unsigned int rcv;
+static volatile replay_TRISGbits_t trisg = { 1, 1 };
+static int on_seen = 0;             // I2C1CONbits.ON all'accesso precedente
+static int trn_written = 0;
+static int scl_seen = 1;
+
+// Stato del bus e degli slave
+static int fault = I2C_FAULT_NONE;
+static int phase = BUS_IDLE;
+static const sim_slave_t *slave;
+static int pointer_set;
+static int pointer;
+static uint8_t regs[0x30];
+static int sda_hold = 0;            // clock mancanti al rilascio di SDA
+static i2c_sim_stats_t counters;
+
+void i2c_sim_fault(int f) {
+    fault = f;
+}
+
+i2c_sim_stats_t i2c_sim_stats(void) {
+    return counters;
+}
+
+static void bus_time(uint64_t us) {
+    stage_time(STAGE_SENSOR, host_ns(), us, 1);
+}
+
+static int scl_line(void) {
+    return trisg.TRISG2 && fault != I2C_FAULT_SCL;
+}
+
+static int sda_line(void) {
+    return trisg.TRISG3 && !sda_hold;
+}
+
+// START: con SDA tenuto basso da uno slave o da un altro master il modulo
+// segnala una collisione (BCL) e non genera la condizione
+static void start(void) {
+    stages[STAGE_SENSOR].calls++;
+    if (fault == I2C_FAULT_SDA && !sda_hold)
+        sda_hold = I2C_SDA_CLOCKS; // uno slave rimasto a metà di un byte
+    if (sda_hold || fault == I2C_FAULT_BCL) {
+        stat.BCL = 1;
+        con.bits.SEN = 0;
+        phase = BUS_IDLE;
+        counters.collisions++;
+        return;
+    }
+    bus_time(I2C_BIT_US);
+    con.bits.SEN = 0;
+    phase = BUS_ADDRESS;
+}
+
+// Un byte dal master, ritorna 1 se lo slave risponde con ACK
+static int slave_write(uint8_t byte) {
+    switch (phase) {
+    case BUS_ADDRESS:
+        slave = NULL;
+        for (unsigned int i = 0; i < NUM_SLAVES; i++) {
+            if (slaves[i].addr == byte >> 1)
+                slave = &slaves[i];
+        }
+        if (!slave || fault == I2C_FAULT_NACK) {
+            phase = BUS_IDLE;
+            counters.nacks++;
+            return 0;
+        }
+        if (byte & 1) {
+            counters.reads++;
+            memset(regs, 0, sizeof(regs));
+            slave->load(regs);
+            phase = BUS_READ;
+        } else {
+            pointer_set = 0;
+            phase = BUS_WRITE;
+        }
+        return 1;
+    case BUS_WRITE:
+        // il primo byte seleziona il registro, gli altri sono ignorati
+        if (!pointer_set)
+            pointer = (byte & slave->cmd_mask) % slave->size;
+        pointer_set = 1;
+        return 1;
+    }
+    return 0;
+}
+
+static void transmit(void) {
+    if (stat.BCL)
+        return; // scrittura di TRN ignorata dopo una collisione
+    if (fault == I2C_FAULT_SCL) {
+        stat.TRSTAT = 1; // SCL tenuto basso: il byte non parte
+        return;
+    }
+    bus_time(I2C_BYTE_US);
+    stat.ACKSTAT = !slave_write(trn & 0xFF);
+    stat.TRSTAT = 0;
+}
+
+static void receive(void) {
+    if (phase == BUS_READ) {
+        rcv = regs[pointer];
+        pointer = (pointer + 1) % slave->size;
+    } else {
+        rcv = 0xFF; // nessuno slave trasmette, SDA resta alto
+    }
+    bus_time(I2C_RECV_US);
+    stat.RBF = 1;
+    con.bits.RCEN = 0;
+}
+
+// Spegnendo il modulo le operazioni in corso vengono annullate e i pin
+// tornano alla porta
+static void module_off(void) {
+    con.w &= ~0x1F;
+    stat.TRSTAT = 0;
+    stat.RBF = 0;
+    trn_written = 0;
+    phase = BUS_IDLE;
+}
+
+// Esegue le richieste scritte dal firmware dopo l'accesso precedente
+static void update(void) {
+    int scl = scl_line();
+
+    if (!con.bits.ON) {
+        if (on_seen)
+            module_off();
+        // Bus recovery: ogni fronte di salita di SCL fa avanzare lo slave
+        // che tiene SDA basso
+        if (scl && !scl_seen && sda_hold) {
+            counters.clocks++;
+            sda_hold--;
+        }
+        scl_seen = scl;
+        on_seen = 0;
+        return;
+    }
+    scl_seen = scl;
+    on_seen = 1;
+
+    if (trn_written) {
+        trn_written = 0;
+        transmit();
+    }
+    if (fault != I2C_FAULT_SCL) {
+        if (con.bits.SEN)
+            start();
+        if (con.bits.RSEN) {
+            bus_time(I2C_BIT_US);
+            con.bits.RSEN = 0;
+            phase = BUS_ADDRESS;
+        }
+        if (con.bits.RCEN && !stat.RBF)
+            receive();
+        if (con.bits.ACKEN) {
+            bus_time(I2C_BIT_US);
+            con.bits.ACKEN = 0;
+        }
+        if (con.bits.PEN) {
+            bus_time(I2C_BIT_US);
+            con.bits.PEN = 0;
+            phase = BUS_IDLE;
+        }
+    }
+
+    // Operazione bloccata: il polling del firmware fa scorrere il tempo
+    if ((con.w & 0x1F) || stat.TRSTAT)
+        vt_advance(1);
+}
+
+// ---------------------------------------------------------------- Registri
+
+volatile replay_I2C1CON_t *replay_i2c1con(void) {
+    update();
+    return &con;
+}
+
+volatile replay_I2C1STATbits_t *replay_i2c1stat(void) {
+    update();
+    return &stat;
+}
+
+// Solo scritture: il byte parte all'accesso successivo
+volatile unsigned int *replay_i2c1trn(void) {
+    update();
+    trn_written = 1;
+    return &trn;
+}
+
+unsigned int replay_i2c1rcv(void) {
+    update();
+    stat.RBF = 0;
+    return rcv;
+}
+
+volatile replay_TRISGbits_t *replay_trisg(void) {
+    update();
+    return &trisg;
+}
+
+replay_PORTGbits_t replay_portg(void) {
+    replay_PORTGbits_t port;
+
+    update();
+    port.RG2 = scl_line();
+    port.RG3 = sda_line();
+    return port;
+}
@@ -0,0 +1,130 @@
+/*
+ * File:   p32xxxx.h (replay)
+ *
+ * Sostituisce l'header di XC32 nella compilazione su host: solo i registri
+ * usati direttamente dai sorgenti del firmware compilati nel replay, come
+ * variabili normali. I driver che accedono all'hardware sono sostituiti
+ * da hal.c, tranne spi.c che gira su una flash simulata (flash.c) e i2c.c
+ * che gira su un modello del modulo I2C1 e degli slave (i2c_sim.c).
+ */
+
+#ifndef REPLAY_P32XXXX_H
+#define REPLAY_P32XXXX_H
+
+#include <stdint.h>
+
+// LED della porta A
+extern volatile unsigned int LATA;
+
+// LED RGB
+typedef struct {
+    unsigned LATD2:1;
+    unsigned LATD3:1;
+    unsigned LATD12:1;
+} replay_LATDbits_t;
+extern volatile replay_LATDbits_t LATDbits;
+
+// PWM del buzzer
+typedef struct {
+    unsigned ON:1;
+} replay_OC1CONbits_t;
+extern volatile replay_OC1CONbits_t OC1CONbits;
+
+// SPI1 e chip select della flash: gli accessi passano da flash.c, che
+// simula la memoria collegata un byte alla volta
+typedef struct {
+    unsigned TRISF2:1;
+    unsigned TRISF6:1;
+    unsigned TRISF7:1;
+    unsigned TRISF8:1;
+} replay_TRISFbits_t;
+extern volatile replay_TRISFbits_t TRISFbits;
+
+typedef struct {
+    unsigned LATF8:1;
+} replay_LATFbits_t;
+volatile replay_LATFbits_t *replay_latf(void);
+#define LATFbits (*replay_latf())
+
+typedef struct {
+    unsigned ON:1;
+} replay_SPI1CONbits_t;
+extern volatile replay_SPI1CONbits_t SPI1CONbits;
+extern volatile unsigned int SPI1CON, SPI1BRG, RPF2R, SDI1R;
+
+typedef struct {
+    unsigned SPITBE:1;
+    unsigned SPIRBF:1;
+} replay_SPI1STATbits_t;
+replay_SPI1STATbits_t replay_spi1_stat(void);
+volatile unsigned int *replay_spi1_buf(void);
+#define SPI1STATbits (replay_spi1_stat())
+#define SPI1BUF (*replay_spi1_buf())
+
+// I2C1 e pin del bus (SCL1 = RG2, SDA1 = RG3): gli accessi passano da
+// i2c_sim.c, che esegue le operazioni richieste dai bit di I2C1CON e le
+// scritture di I2C1TRN all'accesso successivo
+typedef struct {
+    unsigned SEN:1;
+    unsigned RSEN:1;
+    unsigned PEN:1;
+    unsigned RCEN:1;
+    unsigned ACKEN:1;
+    unsigned ACKDT:1;
+    unsigned :9;
+    unsigned ON:1;
+} replay_I2C1CONbits_t;
+typedef union {
+    replay_I2C1CONbits_t bits;
+    unsigned int w;
+} replay_I2C1CON_t;
+volatile replay_I2C1CON_t *replay_i2c1con(void);
+#define I2C1CON (replay_i2c1con()->w)
+#define I2C1CONbits (replay_i2c1con()->bits)
+
+typedef struct {
+    unsigned TBF:1;
+    unsigned RBF:1;
+    unsigned :8;
+    unsigned BCL:1;
+    unsigned :3;
+    unsigned TRSTAT:1;
+    unsigned ACKSTAT:1;
+} replay_I2C1STATbits_t;
+volatile replay_I2C1STATbits_t *replay_i2c1stat(void);
+volatile unsigned int *replay_i2c1trn(void);
+unsigned int replay_i2c1rcv(void);
+#define I2C1STATbits (*replay_i2c1stat())
+#define I2C1TRN (*replay_i2c1trn())
+#define I2C1RCV (replay_i2c1rcv())
+extern volatile unsigned int I2C1BRG;
+
+typedef struct {
+    unsigned TRISG2:1;
+    unsigned TRISG3:1;
+} replay_TRISGbits_t;
+volatile replay_TRISGbits_t *replay_trisg(void);
+#define TRISGbits (*replay_trisg())
+
+typedef struct {
+    unsigned LATG2:1;
+    unsigned LATG3:1;
+} replay_LATGbits_t;
+extern volatile replay_LATGbits_t LATGbits;
+
+typedef struct {
+    unsigned RG2:1;
+    unsigned RG3:1;
+} replay_PORTGbits_t;
+replay_PORTGbits_t replay_portg(void);
+#define PORTGbits (replay_portg())
+
+// Core timer in tempo virtuale (SYSCLK/2)
+unsigned int replay_mfc0(int reg, int sel);
+
+#define __builtin_mfc0(reg, sel)        replay_mfc0(reg, sel)
+#define __builtin_disable_interrupts()  ((void)0)
+#define __builtin_enable_interrupts()   ((void)0)
+#define _nop()                          ((void)0)
+
+#endif // REPLAY_P32XXXX_H
@@ -0,0 +1,376 @@
+/*
+ * File:   replay.c
+ *
+ * Replay su host della pipeline di acquisizione e visualizzazione: esegue
+ * il main loop del firmware (app_step() di newmain.c) in tempo virtuale,
+ * alimentando il TSL2561 con una traccia CH0/CH1 registrata, e scrive un
+ * log di tutte le uscite (LED, frame LCD, righe UART, scritture in flash)
+ * da confrontare con un golden. A fine esecuzione stampa su stderr il
+ * tempo per stadio.
+ *
+ * La traccia è il CSV dello streaming (menu 5, "t_ms,ch0,ch1,lux,gain"):
+ * le righe che non iniziano con un numero vengono ignorate, quindi si può
+ * usare direttamente la cattura della seriale.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <p32xxxx.h>
+
+#include "hal.h"
+#include "events.h"
+
+// Dal firmware (newmain.c)
+void app_init(void);
+int app_step(void);
+
+#define DEFAULT_KEYS    "1\r"   // avvia il monitoraggio
+#define STREAM_KEYS     "5\r"   // monitoraggio con streaming
+#define DEFAULT_PART    "s25fl132k" // flash della Basys MX3
+#define TAIL_MS         3000    // tempo simulato dopo la pressione di BTNC
+#define ACCEL_G         1024    // conteggi per g dell'accelerometro (+-2 g)
+#define SHAKE_MS        200     // durata della scossa (-m)
+#define SHAKE_COUNTS    600     // ampiezza su X, cambia segno ogni 10 ms
+#define MAX_LINE        512
+
+typedef struct {
+    uint32_t t;
+    uint16_t ch0;
+    uint16_t ch1;
+} trace_row_t;
+
+static trace_row_t *trace;
+static int trace_length = 0;
+static int trace_pos = 0;
+
+static char *keys;      // sequenza di -k, lunga quanto l'argomento
+static int keys_pos = 0;
+static unsigned int button_ms = 0;
+static unsigned int shake_ms = 0;
+static int shake_set = 0;
+
+static FILE *log_out;
+static FILE *golden;
+static int log_lines = 0;
+static int mismatch_line = 0;
+static char mismatch_expected[MAX_LINE];
+static char mismatch_actual[MAX_LINE];
+
+static unsigned int lcd_frames = 0;
+static unsigned int led_changes = 0;
+
+static void usage(void) {
+    fprintf(stderr,
+        "Uso: replay [-k tasti] [-s] [-b ms] [-m ms] [-i] [-o log] [-g golden] [-f flash.bin] [-p parte] traccia.csv\n"
+        "  -k  caratteri inviati su UART4 dall'avvio, \\r e \\n ammessi (default \"1\\r\")\n"
+        "  -s  monitoraggio con streaming, come -k \"5\\r\"\n"
+        "  -b  pressione di BTNC al tempo indicato in ms (default: fine traccia)\n"
+        "  -m  scossa della scheda (accelerometro) al tempo indicato in ms\n"
+        "  -i  prova dei guasti sul bus I2C1 (NACK, SDA e SCL bloccati, collisione),\n"
+        "      esce con 1 se un controllo fallisce\n"
+        "  -o  scrive il log delle uscite su file (default stdout)\n"
+        "  -g  confronta il log con un golden, esce con 1 alla prima differenza\n"
+        "  -f  salva l'immagine finale della flash\n"
+        "  -p  flash simulata su SPI1 (default %s); esce con 1 se il firmware\n"
+        "      non ne riconosce la geometria. Parti disponibili:\n", DEFAULT_PART);
+    flash_sim_list();
+    exit(2);
+}
+
+// Converte le sequenze \r e \n scritte sulla riga di comando; il buffer
+// è lungo quanto l'argomento, nessun tasto viene scartato
+static void parse_keys(const char *s) {
+    int n = 0;
+
+    free(keys);
+    if (!(keys = malloc(strlen(s) + 1))) {
+        perror("-k");
+        exit(2);
+    }
+    while (*s) {
+        if (s[0] == '\\' && s[1] == 'r') {
+            keys[n++] = '\r';
+            s += 2;
+        } else if (s[0] == '\\' && s[1] == 'n') {
+            keys[n++] = '\n';
+            s += 2;
+        } else {
+            keys[n++] = *s++;
+        }
+    }
+    keys[n] = '\0';
+}
+
+static void load_trace(const char *path) {
+    char line[MAX_LINE];
+    int capacity = 1024;
+    unsigned long t;
+    unsigned int ch0, ch1;
+    FILE *f = fopen(path, "r");
+
+    if (!f) {
+        perror(path);
+        exit(2);
+    }
+    trace = malloc(capacity * sizeof(trace_row_t));
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "%lu,%u,%u", &t, &ch0, &ch1) != 3)
+            continue;
+        if (trace_length == capacity) {
+            capacity *= 2;
+            trace = realloc(trace, capacity * sizeof(trace_row_t));
+        }
+        trace[trace_length].t = (uint32_t)t;
+        trace[trace_length].ch0 = (uint16_t)ch0;
+        trace[trace_length].ch1 = (uint16_t)ch1;
+        trace_length++;
+    }
+    fclose(f);
+    if (trace_length == 0) {
+        fprintf(stderr, "%s: nessun campione\n", path);
+        exit(2);
+    }
+    // I tempi della traccia ripartono da zero
+    for (int i = trace_length - 1; i >= 0; i--)
+        trace[i].t -= trace[0].t;
+}
+
+// Il sensore restituisce l'ultimo campione della traccia già integrato
+void replay_sensor(uint16_t *ch0, uint16_t *ch1) {
+    unsigned int now = (unsigned int)(vt_now_us() / 1000);
+
+    while (trace_pos + 1 < trace_length && trace[trace_pos + 1].t <= now)
+        trace_pos++;
+    *ch0 = trace[trace_pos].ch0;
+    *ch1 = trace[trace_pos].ch1;
+}
+
+// Scheda in piano (gravità su Z+), scossa lungo X se richiesta con -m
+void replay_accel(int16_t xyz[3]) {
+    unsigned int now = (unsigned int)(vt_now_us() / 1000);
+
+    xyz[0] = 0;
+    xyz[1] = 0;
+    xyz[2] = ACCEL_G;
+    if (shake_set && now >= shake_ms && now < shake_ms + SHAKE_MS)
+        xyz[0] = (now / 10) % 2 ? SHAKE_COUNTS : -SHAKE_COUNTS;
+}
+
+// Ingressi programmati, chiamata a ogni tick da 1ms: un carattere per
+// tick su UART4 (alla velocità della seriale) e la pressione di BTNC
+void replay_tick(unsigned int ms) {
+    if (keys[keys_pos])
+        event_push(EV_UART_RX, (uint8_t)keys[keys_pos++]);
+    if (ms == button_ms)
+        event_push(EV_BUTTON, 0);
+}
+
+void replay_log(const char *kind, const char *fmt, ...) {
+    char line[MAX_LINE];
+    char expected[MAX_LINE];
+    uint64_t us = vt_now_us();
+    va_list args;
+    int n;
+
+    n = snprintf(line, sizeof(line), "%8u.%03u %-5s ",
+                 (unsigned int)(us / 1000), (unsigned int)(us % 1000), kind);
+    va_start(args, fmt);
+    vsnprintf(&line[n], sizeof(line) - n, fmt, args);
+    va_end(args);
+
+    fprintf(log_out, "%s\n", line);
+    log_lines++;
+
+    if (!golden || mismatch_line)
+        return;
+    if (!fgets(expected, sizeof(expected), golden))
+        strcpy(expected, "(fine del golden)");
+    expected[strcspn(expected, "\r\n")] = '\0';
+    if (strcmp(expected, line) != 0) {
+        mismatch_line = log_lines;
+        strcpy(mismatch_expected, expected);
+        strcpy(mismatch_actual, line);
+    }
+}
+
+// LED e LCD vengono registrati solo a fine iterazione del main loop,
+// così un frame LCD non compare a metà aggiornamento
+static void capture_outputs(void) {
+    static unsigned int last_leds = ~0u;
+    static int last_rgb = -1;
+    static char last1[17], last2[17];
+    static unsigned char last_glyphs[64];
+    unsigned char glyphs[64];
+    char line1[17], line2[17];
+    unsigned int leds = LATA & 0xFF;
+    int rgb = (LATDbits.LATD2 << 2) | (LATDbits.LATD12 << 1) | LATDbits.LATD3;
+
+    if (leds != last_leds || rgb != last_rgb) {
+        replay_log("LED", "0x%02X rgb %d%d%d", leds,
+                   LATDbits.LATD2, LATDbits.LATD12, LATDbits.LATD3);
+        last_leds = leds;
+        last_rgb = rgb;
+        led_changes++;
+    }
+    // Un glifo ridefinito compare prima del frame che lo usa
+    lcd_glyphs(glyphs);
+    for (int g = 0; g < 8; g++) {
+        unsigned char *p = &glyphs[g * 8];
+        if (memcmp(p, &last_glyphs[g * 8], 8) == 0)
+            continue;
+        replay_log("LCDG", "%c %02X %02X %02X %02X %02X %02X %02X %02X",
+                   'a' + g, p[0], p[1], p[2], p[3], p[4], p[5], p[6], p[7]);
+        memcpy(&last_glyphs[g * 8], p, 8);
+    }
+    lcd_frame(line1, line2);
+    if (strcmp(line1, last1) != 0 || strcmp(line2, last2) != 0) {
+        replay_log("LCD", "\"%s\" \"%s\"", line1, line2);
+        strcpy(last1, line1);
+        strcpy(last2, line2);
+        lcd_frames++;
+    }
+}
+
+static void report(uint64_t total_ns, uint64_t step_ns) {
+    uint64_t virtual_us = vt_now_us();
+    uint64_t stages_ns = 0;
+
+    fprintf(stderr, "Traccia: %d campioni, %u ms\n", trace_length, trace[trace_length - 1].t);
+    fprintf(stderr, "Tempo virtuale %.3f s, tempo host %.3f s (%.0fx)\n",
+            virtual_us / 1e6, total_ns / 1e9, virtual_us * 1e3 / (total_ns ? total_ns : 1));
+    fprintf(stderr, "Uscite: %d voci di log, %u frame LCD, %u cambi LED, %lu byte UART\n",
+            log_lines, lcd_frames, led_changes, uart_bytes());
+    fprintf(stderr, "%-12s %10s %16s %10s\n", "stadio", "chiamate", "dispositivo ms", "host ms");
+    for (int i = 0; i < NUM_STAGES; i++) {
+        fprintf(stderr, "%-12s %10lu %16.3f %10.3f\n", stages[i].name, stages[i].calls,
+                stages[i].device_us / 1e3, stages[i].host_ns / 1e6);
+        stages_ns += stages[i].host_ns;
+    }
+    // Il resto del main loop: logica del firmware (calcolo lux, codec,
+    // formattazione, menu) eseguita dall'host
+    fprintf(stderr, "%-12s %10s %16s %10.3f\n", "logica", "-", "-",
+            (step_ns > stages_ns ? step_ns - stages_ns : 0) / 1e6);
+}
+
+int main(int argc, char **argv) {
+    const char *flash_path = NULL;
+    const char *part = DEFAULT_PART;
+    int button_set = 0;
+    int faults = 0;
+    int failed = 0;
+    int opt;
+
+    log_out = stdout;
+    parse_keys(DEFAULT_KEYS);
+    while ((opt = getopt(argc, argv, "k:sb:m:io:g:f:p:")) != -1) {
+        switch (opt) {
+        case 'k':
+            parse_keys(optarg);
+            break;
+        case 's':
+            parse_keys(STREAM_KEYS);
+            break;
+        case 'b':
+            button_ms = (unsigned int)strtoul(optarg, NULL, 10);
+            button_set = 1;
+            break;
+        case 'm':
+            shake_ms = (unsigned int)strtoul(optarg, NULL, 10);
+            shake_set = 1;
+            break;
+        case 'i':
+            faults = 1;
+            break;
+        case 'o':
+            if (!(log_out = fopen(optarg, "w"))) {
+                perror(optarg);
+                return 2;
+            }
+            break;
+        case 'g':
+            if (!(golden = fopen(optarg, "r"))) {
+                perror(optarg);
+                return 2;
+            }
+            break;
+        case 'f':
+            flash_path = optarg;
+            break;
+        case 'p':
+            part = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if (optind != argc - 1 || !flash_sim_select(part))
+        usage();
+
+    load_trace(argv[optind]);
+    if (!button_set)
+        button_ms = trace[trace_length - 1].t + 1;
+    // Flash nuova, tutta cancellata
+    memset(flash_image, 0xFF, sizeof(flash_image));
+
+    uint64_t start = host_ns();
+    uint64_t step_ns = 0;
+    uint64_t t0 = start;
+
+    app_init();
+    step_ns += host_ns() - t0;
+    capture_outputs();
+    int detected = flash_sim_check();
+    if (faults)
+        failed = i2c_faults_direct();
+    for (;;) {
+        uint64_t step_start = vt_now_us();
+        t0 = host_ns();
+        int busy = app_step();
+        step_ns += host_ns() - t0;
+        capture_outputs();
+        if (faults)
+            i2c_faults_step(step_start);
+        if (busy)
+            continue;
+        if (vt_now_us() / 1000 >= (uint64_t)button_ms + TAIL_MS)
+            break;
+        vt_advance(1000 - vt_now_us() % 1000); // main loop inattivo fino al tick
+    }
+    report(host_ns() - start, step_ns);
+    if (faults)
+        failed += i2c_faults_report();
+
+    if (log_out != stdout)
+        fclose(log_out);
+    if (flash_path) {
+        FILE *f = fopen(flash_path, "wb");
+        if (!f || fwrite(flash_image, 1, sizeof(flash_image), f) != sizeof(flash_image)) {
+            perror(flash_path);
+            return 2;
+        }
+        fclose(f);
+    }
+    if (golden) {
+        char extra[MAX_LINE];
+        if (!mismatch_line && fgets(extra, sizeof(extra), golden)) {
+            mismatch_line = log_lines + 1;
+            extra[strcspn(extra, "\r\n")] = '\0';
+            strcpy(mismatch_expected, extra);
+            strcpy(mismatch_actual, "(fine del log)");
+        }
+        if (mismatch_line) {
+            fprintf(stderr, "Golden: differenza alla riga %d\n  atteso:   %s\n  ottenuto: %s\n",
+                    mismatch_line, mismatch_expected, mismatch_actual);
+            return 1;
+        }
+        fprintf(stderr, "Golden: identico (%d righe)\n", log_lines);
+    }
+    if (!detected) {
+        fprintf(stderr, "Flash: geometria rilevata diversa da %s\n", part);
+        return 1;
+    }
+    return failed ? 1 : 0;
+}